@@ -2,6 +2,17 @@
 
 os.execute('del /q *.sln *.vcxproj *.vcxproj.filters 2>nul')
 
+newoption {
+   trigger = "simd",
+   value = "SET",
+   description = "Instruction set for the SIMD kernels",
+   allowed = {
+      { "avx2", "AVX2, 8 lanes" },
+      { "sse2", "SSE2, 4 lanes, for CPUs without AVX2" }
+   },
+   default = "avx2"
+}
+
 workspace "Sandbox"
    architecture "x64"
    configurations { "Debug", "Release", "Dist" }
@@ -11,6 +22,12 @@ workspace "Sandbox"
    filter "system:windows"
       buildoptions { "/EHsc", "/Zc:preprocessor", "/Zc:__cplusplus" }
 
+   -- MSVC only defines __AVX2__ (and so only builds the 8-lane kernels) under /arch:AVX2
+   filter "options:simd=avx2"
+      vectorextensions "AVX2"
+
+   filter {}
+
 OutputDir = "%{cfg.system}-%{cfg.architecture}/%{cfg.buildcfg}"
 
 group ""
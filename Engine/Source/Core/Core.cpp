@@ -114,6 +114,21 @@ namespace wf
 		g_gameState.timer.setFixedTimestep(timestep);
 	}
 
+	float getFixedAlpha()
+	{
+		return g_gameState.timer.getFixedAlpha();
+	}
+
+	const FixedStepPolicy& getFixedStepPolicy()
+	{
+		return g_gameState.timer.getFixedStepPolicy();
+	}
+
+	void setFixedStepPolicy(const FixedStepPolicy& policy)
+	{
+		g_gameState.timer.setFixedStepPolicy(policy);
+	}
+
 	float getFps()
 	{
 		return g_gameState.timer.getFps();
@@ -179,7 +194,7 @@ namespace wf
 		return g_gameState.inputHandler.isMouseButtonHeld(button);
 	}
 
-	Vec3 getMouseWorldPosition(const CameraComponent& camera)
+	Ray getMouseRay(const CameraComponent& camera)
 	{
 		Vec2 mousePos = getMousePosition();
 		Vec2 screenSize = getWindow().getSize();
@@ -200,11 +215,16 @@ namespace wf
 		worldNear /= worldNear.w;
 		worldFar /= worldFar.w;
 
-		Vec3 dir = glm::normalize(Vec3(worldFar - worldNear));
+		return { Vec3(worldNear), glm::normalize(Vec3(worldFar - worldNear)) };
+	}
+
+	Vec3 getMouseWorldPosition(const CameraComponent& camera, float planeZ)
+	{
+		Ray ray = getMouseRay(camera);
 
-		// intersect ray with Z=0 plane
-		float t = -worldNear.z / dir.z;
-		return Vec3(worldNear) + dir * t;
+		// intersect ray with the plane
+		float t = (planeZ - ray.origin.z) / ray.direction.z;
+		return ray.at(t);
 	}
 
 	Vec2 getMousePosition()
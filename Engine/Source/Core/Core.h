@@ -53,6 +53,9 @@ namespace wf
 	float getDeltaTime();
 	float getFixedTimestep();
 	void setFixedTimestep(float timestep = 1.f / 60.f);
+	float getFixedAlpha();
+	const FixedStepPolicy& getFixedStepPolicy();
+	void setFixedStepPolicy(const FixedStepPolicy& policy);
 	float getFps();
 	void createTimer(float duration, TimerCallback callback, bool autoRenew = false, int renewCount = -1);
 	void pauseTimers(bool pause = true);
@@ -68,7 +71,15 @@ namespace wf
 	bool isMouseButtonReleased(int button);
 	bool isMouseButtonHeld(int button);
 
-	Vec3 getMouseWorldPosition(const CameraComponent& camera);
+	/**
+	 * @brief The ray from the camera through the mouse, for picking
+	 */
+	Ray getMouseRay(const CameraComponent& camera);
+
+	/**
+	 * @brief Where the mouse ray meets the plane at the given depth
+	 */
+	Vec3 getMouseWorldPosition(const CameraComponent& camera, float planeZ = 0.f);
 	Vec2 getMousePosition();
 	Vec2 getMouseWheel();
 	Vec2 getMouseDelta();
@@ -213,6 +213,105 @@ namespace wf::wgl
 		glBindVertexArray(0);
 	}
 
+	VertexStreamHandle createVertexStream(const MeshBufferHandle& buffers, const std::vector<Vertex>& vertices)
+	{
+		VertexStreamHandle stream;
+		if (!GLEW_ARB_buffer_storage || !buffers.vao || vertices.empty()) return stream;
+
+		const GLsizeiptr size = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vec3) * VertexStreamHandle::STREAM_REGIONS);
+
+		glGenBuffers(1, &stream.buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
+		stream.mapped = static_cast<Vec3*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+
+		if (!stream.mapped) {
+			glDeleteBuffers(1, &stream.buffer);
+			return {};
+		}
+
+		stream.vertexCount = static_cast<unsigned int>(vertices.size());
+
+		// every copy starts out the same, so whichever is drawn first is right
+		for (unsigned int r = 0; r < VertexStreamHandle::STREAM_REGIONS; r++) {
+			for (size_t i = 0; i < vertices.size(); i++) {
+				stream.mapped[r * stream.vertexCount + i] = vertices[i].position;
+			}
+		}
+		glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, size);
+
+		bindVertexStream(buffers, stream);
+		return stream;
+	}
+
+	void destroyVertexStream(VertexStreamHandle& stream)
+	{
+		for (auto& fence : stream.fences) {
+			if (fence) glDeleteSync(static_cast<GLsync>(fence));
+		}
+
+		if (stream.buffer) {
+			glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glDeleteBuffers(1, &stream.buffer);
+		}
+		stream = {};
+	}
+
+	Vec3* beginVertexStreamWrite(VertexStreamHandle& stream)
+	{
+		if (!stream.mapped) return nullptr;
+
+		const unsigned int next = (stream.region + 1) % VertexStreamHandle::STREAM_REGIONS;
+
+		// a zero timeout only asks; the GPU is rarely a whole two frames behind, but if it is we'd rather skip than stall
+		if (void*& fence = stream.fences[next]) {
+			GLenum status = glClientWaitSync(static_cast<GLsync>(fence), 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) return nullptr;
+
+			glDeleteSync(static_cast<GLsync>(fence));
+			fence = nullptr;
+		}
+
+		stream.writing = next;
+		return stream.mapped + static_cast<size_t>(next) * stream.vertexCount;
+	}
+
+	void endVertexStreamWrite(VertexStreamHandle& stream, unsigned int first, unsigned int count)
+	{
+		if (!stream.mapped) return;
+
+		if (count) {
+			const GLintptr offset = static_cast<GLintptr>((static_cast<size_t>(stream.writing) * stream.vertexCount + first) * sizeof(Vec3));
+
+			glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+			glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, static_cast<GLsizeiptr>(count * sizeof(Vec3)));
+		}
+
+		stream.region = stream.writing;
+	}
+
+	void bindVertexStream(const MeshBufferHandle& buffers, const VertexStreamHandle& stream)
+	{
+		if (!buffers.vao || !stream.buffer) return;
+
+		const size_t offset = static_cast<size_t>(stream.region) * stream.vertexCount * sizeof(Vec3);
+
+		glBindVertexArray(buffers.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)offset);
+		glBindVertexArray(0);
+	}
+
+	void fenceVertexStream(VertexStreamHandle& stream)
+	{
+		if (!stream.buffer) return;
+
+		void*& fence = stream.fences[stream.region];
+		if (fence) glDeleteSync(static_cast<GLsync>(fence));
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
 	[[nodiscard]] static GLuint compileShader(GLenum type, const char* source)
 	{
 		GLuint shader = glCreateShader(type);
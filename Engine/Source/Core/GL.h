@@ -27,6 +27,24 @@ namespace wf::wgl
 		unsigned int ebo{};
 	};
 
+	/**
+	 * @brief Vertex positions streamed through a persistently mapped buffer, apart from the mesh's other attributes.
+	 *
+	 * The buffer holds STREAM_REGIONS copies of the positions back to back. Each write goes into the next copy while the
+	 * GPU may still be drawing from the others, with a fence per copy saying when it's done with it.
+	 */
+	struct VertexStreamHandle
+	{
+		static constexpr unsigned int STREAM_REGIONS = 3;
+
+		unsigned int buffer{};
+		Vec3* mapped{ nullptr };									// start of the first copy
+		unsigned int vertexCount{};									// positions per copy
+		unsigned int region{};										// the copy drawn from
+		unsigned int writing{};										// the copy being written, between begin and end
+		void* fences[STREAM_REGIONS]{};								// GLsync per copy, from the last draw that read it
+	};
+
 	enum class TextureWrap
 	{
 		DEFAULT = -1,
@@ -144,6 +162,35 @@ namespace wf::wgl
 	);
 	void drawMeshBuffers(const MeshBufferHandle& buffers, unsigned int vertexCount, unsigned int indexCount, bool wireframe = false);
 
+	/**
+	 * @brief Take a mesh's positions from a new stream, starting from the positions in vertices. Returns an empty handle
+	 * if persistent mapping isn't supported, in which case the mesh carries on as it was
+	 */
+	[[nodiscard]] VertexStreamHandle createVertexStream(const MeshBufferHandle& buffers, const std::vector<Vertex>& vertices);
+	void destroyVertexStream(VertexStreamHandle& stream);
+
+	/**
+	 * @brief Start writing positions into the next copy. Null if the GPU is still using it; rather than wait, keep drawing
+	 * the last copy and try again next frame
+	 */
+	[[nodiscard]] Vec3* beginVertexStreamWrite(VertexStreamHandle& stream);
+
+	/**
+	 * @brief Make [first, first + count) of what was written visible to the GPU and draw from it from now on. Anything
+	 * else in the copy is whatever was written to it STREAM_REGIONS writes ago
+	 */
+	void endVertexStreamWrite(VertexStreamHandle& stream, unsigned int first, unsigned int count);
+
+	/**
+	 * @brief Point the mesh's positions at the stream's current copy, ahead of drawing it
+	 */
+	void bindVertexStream(const MeshBufferHandle& buffers, const VertexStreamHandle& stream);
+
+	/**
+	 * @brief Mark the current copy as in use by the draws queued so far
+	 */
+	void fenceVertexStream(VertexStreamHandle& stream);
+
 	[[nodiscard]] ShaderHandle loadShader(const char* vertFilename, const char* fragFilename);
 	[[nodiscard]] ShaderHandle loadShaderFromString(const char* vertexShader, const char* fragmentShader);
 	void useShader(const ShaderHandle& shader);
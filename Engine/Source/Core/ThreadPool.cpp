@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace wf
+{
+	ThreadPool::ThreadPool(size_t threadCount)
+	{
+		if (threadCount == 0) {
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		m_workers.reserve(threadCount - 1);
+		for (size_t i = 1; i < threadCount; i++) {
+			m_workers.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wake.notify_all();
+
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void ThreadPool::parallelFor(size_t count, const RangeFunc& func, size_t grain)
+	{
+		if (count == 0) return;
+
+		grain = std::max<size_t>(grain, 1);
+
+		// not worth waking anyone up
+		if (m_workers.empty() || count <= grain) {
+			func(0, count);
+			return;
+		}
+
+		// a few chunks per thread so uneven work balances out
+		size_t chunks = getThreadCount() * 4;
+		size_t chunkSize = std::max(grain, (count + chunks - 1) / chunks);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &func;
+			m_count = count;
+			m_chunkSize = chunkSize;
+			m_nextChunk = 0;
+			m_activeWorkers = m_workers.size();
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		runChunks();
+
+		// wait for everyone to be idle so nobody is still holding the job when we return
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_activeWorkers == 0; });
+		m_job = nullptr;
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		uint64_t seen = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [&]() { return m_stopping || m_generation != seen; });
+
+				if (m_stopping) return;
+				seen = m_generation;
+			}
+
+			runChunks();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_activeWorkers == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	void ThreadPool::runChunks()
+	{
+		while (true) {
+			size_t begin = m_nextChunk.fetch_add(m_chunkSize);
+			if (begin >= m_count) return;
+
+			(*m_job)(begin, std::min(begin + m_chunkSize, m_count));
+		}
+	}
+}
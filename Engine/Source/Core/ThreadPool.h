@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wf
+{
+	/**
+	 * @brief Fixed pool of worker threads for splitting loops across cores.
+	 *
+	 * The calling thread joins in, so a pool of N threads has N - 1 workers. parallelFor() doesn't return until every
+	 * chunk has run and every worker is idle again, so the job can safely capture locals by reference.
+	 */
+	class ThreadPool
+	{
+	public:
+		using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+		/**
+		 * @brief Create the pool. 0 threads means one per hardware thread
+		 */
+		explicit ThreadPool(size_t threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * @brief Total threads taking part in a parallelFor, including the caller
+		 */
+		size_t getThreadCount() const { return m_workers.size() + 1; }
+
+		/**
+		 * @brief Run func over [0, count) in chunks of at least `grain` items, spread over the pool
+		 *
+		 * Which thread runs which chunk isn't fixed, so func must only touch data belonging to its own range.
+		 */
+		void parallelFor(size_t count, const RangeFunc& func, size_t grain = 1);
+
+	private:
+		void workerLoop();
+		void runChunks();
+
+	private:
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+
+		// current job
+		const RangeFunc* m_job{ nullptr };
+		size_t m_count{ 0 };
+		size_t m_chunkSize{ 1 };
+		std::atomic<size_t> m_nextChunk{ 0 };
+
+		uint64_t m_generation{ 0 };								// bumped for each job so workers know to wake
+		size_t m_activeWorkers{ 0 };
+		bool m_stopping{ false };
+	};
+}
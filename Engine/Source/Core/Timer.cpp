@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "Timer.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace wf
 {
 	void Timer::tick(bool tickCustomTimers)
@@ -15,10 +18,16 @@ namespace wf
 		m_lastTime = m_currentTime;
 		m_frameCount++;
 		m_fixedAccumulator += m_deltaTime;
+		m_fixedSteps = 0;
+
+		// a long stall (breakpoint, loading, dragging the window) shouldn't have to be paid back in full
+		if (m_fixedPolicy.maxAccumulated > 0.f) {
+			m_fixedAccumulator = std::min(m_fixedAccumulator, m_fixedPolicy.maxAccumulated);
+		}
 
 		// so that the fixed update runs at least once on the first frame
 		if (m_frameCount == 1) {
-			m_fixedAccumulator = m_fixedTimestep;
+			m_fixedAccumulator = m_fixedPolicy.timestep;
 		}
 
 		refreshFps();
@@ -30,8 +39,19 @@ namespace wf
 
 	bool Timer::isFixedUpdateReady()
 	{
-		bool ret = m_fixedAccumulator >= m_fixedTimestep;
-		if (ret) m_fixedAccumulator -= m_fixedTimestep;
+		const float timestep = m_fixedPolicy.timestep;
+
+		// done our share for this frame; drop whole steps still owed so they don't snowball, but keep the remainder
+		if (m_fixedPolicy.maxStepsPerFrame && m_fixedSteps >= m_fixedPolicy.maxStepsPerFrame) {
+			m_fixedAccumulator = std::fmod(m_fixedAccumulator, timestep);
+			return false;
+		}
+
+		bool ret = m_fixedAccumulator >= timestep;
+		if (ret) {
+			m_fixedAccumulator -= timestep;
+			m_fixedSteps++;
+		}
 		return ret;
 	}
 
@@ -42,12 +62,27 @@ namespace wf
 
 	float Timer::getFixedTimestep() const
 	{
-		return m_fixedTimestep;
+		return m_fixedPolicy.timestep;
 	}
 
 	void Timer::setFixedTimestep(float timestep)
 	{
-		m_fixedTimestep = timestep;
+		m_fixedPolicy.timestep = timestep;
+	}
+
+	float Timer::getFixedAlpha() const
+	{
+		return std::clamp(m_fixedAccumulator / m_fixedPolicy.timestep, 0.f, 1.f);
+	}
+
+	const FixedStepPolicy& Timer::getFixedStepPolicy() const
+	{
+		return m_fixedPolicy;
+	}
+
+	void Timer::setFixedStepPolicy(const FixedStepPolicy& policy)
+	{
+		m_fixedPolicy = policy;
 	}
 
 	float Timer::getFps() const
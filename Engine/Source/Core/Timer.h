@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
@@ -45,6 +46,19 @@ namespace wf
 		TimerCallback expiryCallback;
 	};
 
+	/**
+	 * @brief How the fixed update keeps up with real time.
+	 *
+	 * If a frame takes longer than the fixed steps it has to run, the next frame owes even more, and so on. Capping the
+	 * steps per frame and the time that can be owed lets the simulation fall behind real time instead.
+	 */
+	struct FixedStepPolicy
+	{
+		float timestep{ 1.f / 60.f };								// length of each fixed step
+		uint32_t maxStepsPerFrame{ 5 };								// most fixed steps run in one frame; 0 for no limit
+		float maxAccumulated{ .25f };								// most time that can be owed; anything past it is dropped. 0 for no limit
+	};
+
 	class Timer
 	{
 	public:
@@ -57,6 +71,14 @@ namespace wf
 		float getDeltaTime() const;
 		float getFixedTimestep() const;
 		void setFixedTimestep(float timestep);
+
+		/**
+		 * @brief How far real time has got through the next fixed step, 0 - 1; for drawing between the last two steps
+		 */
+		float getFixedAlpha() const;
+
+		const FixedStepPolicy& getFixedStepPolicy() const;
+		void setFixedStepPolicy(const FixedStepPolicy& policy);
 		float getFps() const;
 
 		/**
@@ -80,11 +102,12 @@ namespace wf
 
 	private:
 		// config
-		float m_fixedTimestep{ 1.f / 60.f };
+		FixedStepPolicy m_fixedPolicy{};
 
 		// state
 		float m_deltaTime{ 0.f };
 		float m_fixedAccumulator{ 0.f };
+		uint32_t m_fixedSteps{ 0 };									// fixed steps run so far this frame
 		size_t m_frameCount{ 0 };
 		float m_fps{ 0.f };
 
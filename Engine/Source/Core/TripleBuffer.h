@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace wf
+{
+	/**
+	 * @brief Lock-free hand-off of whole values from one writing thread to one reading thread.
+	 *
+	 * The writer fills its back buffer and publishes it; the reader picks up the newest published one whenever it likes.
+	 * Neither ever waits on the other, and neither ever sees the other's buffer mid-update. Buffers are reused rather
+	 * than reset, so containers inside T keep their capacity.
+	 */
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		/**
+		 * @brief The buffer for the writer to fill. Stale; whatever was written to it two publishes ago
+		 */
+		T& getWriteBuffer() { return m_buffers[m_back]; }
+
+		/**
+		 * @brief Hand the write buffer over to the reader
+		 */
+		void publish()
+		{
+			uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+			m_back = previous & INDEX;
+		}
+
+		/**
+		 * @brief Move the reader onto the newest published buffer, if there's one it hasn't seen. True if it moved
+		 */
+		bool acquire()
+		{
+			if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+			uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+			m_front = previous & INDEX;
+			return true;
+		}
+
+		/**
+		 * @brief The buffer the reader last acquired
+		 */
+		const T& getReadBuffer() const { return m_buffers[m_front]; }
+
+	private:
+		static constexpr uint8_t INDEX = 0x3;
+		static constexpr uint8_t FRESH = 0x4;						// the middle buffer hasn't been picked up yet
+
+		std::array<T, 3> m_buffers{};
+		uint8_t m_back{ 0 };										// the writer's
+		std::atomic<uint8_t> m_middle{ 1 };							// in flight between the two, plus FRESH
+		uint8_t m_front{ 2 };										// the reader's
+	};
+}
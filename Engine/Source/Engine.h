@@ -6,10 +6,13 @@
 #include "Core/GL.h"
 #include "Core/Input.h"
 #include "Core/ResourceManager.h"
+#include "Core/ThreadPool.h"
 #include "Core/Timer.h"
+#include "Core/TripleBuffer.h"
 #include "Core/Window.h"
 
 #include "Geometry/Geometry.h"
+#include "Geometry/Heightfield.h"
 #include "Geometry/Mesh.h"
 #include "Geometry/MeshFactory.h"
 #include "Geometry/MeshUtils.h"
@@ -19,6 +22,7 @@
 #include "Math/Bitfield.h"
 #include "Math/Math.h"
 #include "Math/Noise.h"
+#include "Math/SpatialHashGrid.h"
 #include "Math/Splines.h"
 #include "Math/Utils.h"
 
@@ -34,6 +38,7 @@
 #include "Scene/Component/LightComponent.h"
 #include "Scene/Component/MeshRendererComponent.h"
 #include "Scene/Component/NameTagComponent.h"
+#include "Scene/Component/PreviousTransformComponent.h"
 #include "Scene/Component/TransformComponent.h"
 #include "Scene/Scene.h"
 #include "Scene/System.h"
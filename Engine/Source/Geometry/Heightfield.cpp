@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "Heightfield.h"
+
+#include "Geometry/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wf
+{
+	Heightfield Heightfield::fromMesh(const Mesh& mesh, const Vec3& offset)
+	{
+		Heightfield field;
+
+		const size_t vertexCount = mesh.vertices.size();
+		const int count = static_cast<int>(std::lround(std::sqrt(static_cast<double>(vertexCount))));
+
+		if (count < 2 || static_cast<size_t>(count) * count != vertexCount) return field;
+
+		const Vec3 first = mesh.vertices[0].position;
+		const Vec3 nextX = mesh.vertices[1].position;
+		const Vec3 nextZ = mesh.vertices[count].position;
+
+		field.m_origin = { first.x + offset.x, first.z + offset.z };
+		field.m_spacing = { nextX.x - first.x, nextZ.z - first.z };
+		field.m_countX = count;
+		field.m_countZ = count;
+
+		if (field.m_spacing.x <= 0.f || field.m_spacing.y <= 0.f) return {};
+
+		field.m_heights.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) {
+			field.m_heights[i] = mesh.vertices[i].position.y + offset.y;
+		}
+
+		field.updateBounds();
+		return field;
+	}
+
+	Heightfield Heightfield::generate(const Vec2& origin, const Vec2& size, int resolution, const std::function<float(float, float)>& heightFunc)
+	{
+		Heightfield field;
+
+		if (resolution < 1 || size.x <= 0.f || size.y <= 0.f) return field;
+
+		field.m_origin = origin;
+		field.m_spacing = size / static_cast<float>(resolution);
+		field.m_countX = resolution + 1;
+		field.m_countZ = resolution + 1;
+		field.m_heights.resize(static_cast<size_t>(field.m_countX) * field.m_countZ);
+
+		for (int z = 0; z < field.m_countZ; z++) {
+			for (int x = 0; x < field.m_countX; x++) {
+				field.m_heights[static_cast<size_t>(z) * field.m_countX + x] = heightFunc(origin.x + x * field.m_spacing.x, origin.y + z * field.m_spacing.y);
+			}
+		}
+
+		field.updateBounds();
+		return field;
+	}
+
+	bool Heightfield::contains(float x, float z) const
+	{
+		if (!isValid()) return false;
+
+		float fx = (x - m_origin.x) / m_spacing.x;
+		float fz = (z - m_origin.y) / m_spacing.y;
+
+		return fx >= 0.f && fz >= 0.f && fx <= m_countX - 1 && fz <= m_countZ - 1;
+	}
+
+	float Heightfield::getHeight(float x, float z) const
+	{
+		if (!isValid()) return 0.f;
+
+		Cell cell = locate(x, z);
+
+		// same split as the terrain mesh: (x+1, z) to (x, z+1)
+		if (cell.tx + cell.tz <= 1.f) {
+			float h00 = at(cell.x, cell.z);
+			return h00 + (at(cell.x + 1, cell.z) - h00) * cell.tx + (at(cell.x, cell.z + 1) - h00) * cell.tz;
+		}
+
+		float h11 = at(cell.x + 1, cell.z + 1);
+		return h11 + (at(cell.x, cell.z + 1) - h11) * (1.f - cell.tx) + (at(cell.x + 1, cell.z) - h11) * (1.f - cell.tz);
+	}
+
+	Vec3 Heightfield::getNormal(float x, float z) const
+	{
+		if (!isValid()) return { 0.f, 1.f, 0.f };
+
+		Cell cell = locate(x, z);
+
+		float slopeX;
+		float slopeZ;
+
+		if (cell.tx + cell.tz <= 1.f) {
+			float h00 = at(cell.x, cell.z);
+			slopeX = (at(cell.x + 1, cell.z) - h00) / m_spacing.x;
+			slopeZ = (at(cell.x, cell.z + 1) - h00) / m_spacing.y;
+		}
+		else {
+			float h11 = at(cell.x + 1, cell.z + 1);
+			slopeX = (h11 - at(cell.x, cell.z + 1)) / m_spacing.x;
+			slopeZ = (h11 - at(cell.x + 1, cell.z)) / m_spacing.y;
+		}
+
+		return glm::normalize(Vec3{ -slopeX, 1.f, -slopeZ });
+	}
+
+	Heightfield::Cell Heightfield::locate(float x, float z) const
+	{
+		float fx = std::clamp((x - m_origin.x) / m_spacing.x, 0.f, static_cast<float>(m_countX - 1));
+		float fz = std::clamp((z - m_origin.y) / m_spacing.y, 0.f, static_cast<float>(m_countZ - 1));
+
+		// the far edge belongs to the last cell
+		int cx = std::min(static_cast<int>(fx), m_countX - 2);
+		int cz = std::min(static_cast<int>(fz), m_countZ - 2);
+
+		return { cx, cz, fx - cx, fz - cz };
+	}
+
+	void Heightfield::updateBounds()
+	{
+		m_bounds.reset();
+		if (!isValid()) return;
+
+		auto [lowest, highest] = std::minmax_element(m_heights.begin(), m_heights.end());
+
+		m_bounds.extend({ m_origin.x, *lowest, m_origin.y });
+		m_bounds.extend({ m_origin.x + m_spacing.x * (m_countX - 1), *highest, m_origin.y + m_spacing.y * (m_countZ - 1) });
+	}
+}
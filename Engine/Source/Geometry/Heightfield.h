@@ -0,0 +1,81 @@
+#pragma once
+#include "Math/Math.h"
+
+#include <functional>
+#include <vector>
+
+namespace wf
+{
+	struct Mesh;
+
+	/**
+	 * @brief Regular grid of heights (Y) over the XZ plane, for cheap "how high is the ground here" queries.
+	 *
+	 * Heights are sampled on the same two triangles per cell as a Terrain plane is built from, so lookups match what's
+	 * rendered. Any position maps straight to its cell, so height and normal lookups are O(1) however big it is.
+	 */
+	class Heightfield
+	{
+	public:
+		Heightfield() = default;
+
+		/**
+		 * @brief Build from a grid mesh as made by Terrain::createPlane (after any noise etc), offset to where it's placed.
+		 *
+		 * The vertices need to still be a square grid in their original order, x running fastest. Anything else gives
+		 * an invalid heightfield.
+		 */
+		static Heightfield fromMesh(const Mesh& mesh, const Vec3& offset = {});
+
+		/**
+		 * @brief Build by sampling a function of (x, z) over a grid; e.g. the same noise a Terrain was displaced with
+		 */
+		static Heightfield generate(const Vec2& origin, const Vec2& size, int resolution, const std::function<float(float, float)>& heightFunc);
+
+		/**
+		 * @brief Whether there's any data
+		 */
+		bool isValid() const { return m_countX > 1 && m_countZ > 1; }
+
+		/**
+		 * @brief Whether the grid covers this XZ position
+		 */
+		bool contains(float x, float z) const;
+
+		/**
+		 * @brief Height of the surface at this XZ position. Positions off the grid are clamped to its edge
+		 */
+		float getHeight(float x, float z) const;
+
+		/**
+		 * @brief Upward facing surface normal at this XZ position. Positions off the grid are clamped to its edge
+		 */
+		Vec3 getNormal(float x, float z) const;
+
+		/**
+		 * @brief World space bounds, including the lowest and highest points
+		 */
+		const BoundingBox& getBounds() const { return m_bounds; }
+
+	private:
+		struct Cell
+		{
+			int x;
+			int z;
+			float tx;												// 0 - 1 across the cell
+			float tz;
+		};
+
+		Cell locate(float x, float z) const;
+		float at(int x, int z) const { return m_heights[static_cast<size_t>(z) * m_countX + x]; }
+		void updateBounds();
+
+	private:
+		Vec2 m_origin{};											// XZ of the first sample
+		Vec2 m_spacing{ 1.f };										// distance between samples in X and Z
+		int m_countX{ 0 };											// samples along each axis
+		int m_countZ{ 0 };
+		std::vector<float> m_heights;								// row-major, x fastest
+		BoundingBox m_bounds{};
+	};
+}
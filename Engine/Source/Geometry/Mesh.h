@@ -18,6 +18,9 @@ namespace wf
 		bool needsUpdate{ true };						// if the mesh data is dirty and needs re-uploading
 		bool autoUpdate{ true };						// if we want to automatically update the data without having to set the needsUpdate flag
 
+		bool streamPositions{ false };					// positions are written straight into `stream` rather than re-uploaded from the vertices
+		wgl::VertexStreamHandle stream{};				// created along with the buffers, if supported
+
 		BoundingBox getBoundingBox() const
 		{
 			BoundingBox b{};
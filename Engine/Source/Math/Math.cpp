@@ -93,6 +93,20 @@ namespace wf
 		: position(position), rotation(rotation), scale(scale) {
 	}
 
+	Transform Transform::interpolate(const Transform& a, const Transform& b, float t)
+	{
+		Vec3 turn = b.rotation - a.rotation;
+		for (int i = 0; i < 3; i++) {
+			turn[i] = std::remainder(turn[i], 360.f);
+		}
+
+		return Transform(
+			a.position + (b.position - a.position) * t,
+			a.rotation + turn * t,
+			a.scale + (b.scale - a.scale) * t
+		);
+	}
+
 	Mat4 Transform::getTransformMatrix() const
 	{
 		auto transform = Mat4(1.f);
@@ -49,6 +49,17 @@ namespace wf
 		bool contains(const BoundingBox& other) const;		// bounding box encloses another entirely?
 	};
 
+	/**
+	 * @brief Half line from an origin along a (unit) direction
+	 */
+	struct Ray
+	{
+		Vec3 origin{};
+		Vec3 direction{ 0.f, 0.f, -1.f };
+
+		Vec3 at(float t) const { return origin + direction * t; }
+	};
+
 	/**
 	 * @brief Transform utility.
 	 *
@@ -69,6 +80,11 @@ namespace wf
 		 */
 		Mat4 getTransformMatrix() const;
 
+		/**
+		 * @brief Blend between two transforms, 0 being a and 1 being b. Rotations take the short way round
+		 */
+		static Transform interpolate(const Transform& a, const Transform& b, float t);
+
 		/**
 		 * @brief Get the world position of a point
 		 */
@@ -0,0 +1,394 @@
+#include "pch.h"
+#include "Math/SpatialHashGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace wf
+{
+	namespace
+	{
+		// slab test; whether any of the segment from + path * [0, 1] is inside the box
+		bool segmentHitsBox(const BoundingBox& box, const Vec3& from, const Vec3& path)
+		{
+			float enter = 0.f;
+			float leave = 1.f;
+
+			for (int axis = 0; axis < 3; axis++) {
+				if (path[axis] == 0.f) {
+					if (from[axis] < box.min[axis] || from[axis] > box.max[axis]) return false;
+					continue;
+				}
+
+				float t1 = (box.min[axis] - from[axis]) / path[axis];
+				float t2 = (box.max[axis] - from[axis]) / path[axis];
+				if (t1 > t2) std::swap(t1, t2);
+
+				enter = std::max(enter, t1);
+				leave = std::min(leave, t2);
+				if (enter > leave) return false;
+			}
+
+			return true;
+		}
+
+		bool isFinite(const Vec3& v)
+		{
+			return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+		}
+	}
+
+	SpatialHashGrid::SpatialHashGrid(float cellSize, size_t bucketCount)
+	{
+		m_cellSize = cellSize;
+		m_invCellSize = 1.f / cellSize;
+
+		// round up to a power of 2 so we can mask rather than mod
+		size_t count = 1;
+		while (count < bucketCount) count <<= 1;
+		m_buckets.assign(count, INVALID);
+	}
+
+	void SpatialHashGrid::setCellSize(float cellSize)
+	{
+		assert(cellSize > 0.f);
+
+		for (Handle h = 0; h < m_proxies.size(); h++) {
+			if (m_proxies[h].active) unlink(h);
+		}
+
+		m_cellSize = cellSize;
+		m_invCellSize = 1.f / cellSize;
+
+		for (Handle h = 0; h < m_proxies.size(); h++) {
+			if (!m_proxies[h].active) continue;
+
+			m_proxies[h].cells = getCellRange(m_proxies[h].box);
+			link(h);
+		}
+	}
+
+	SpatialHashGrid::Handle SpatialHashGrid::insert(const BoundingBox& box, uint32_t userData)
+	{
+		Handle handle;
+
+		if (m_freeProxy != INVALID) {
+			handle = m_freeProxy;
+			m_freeProxy = m_proxies[handle].nextFree;
+		}
+		else {
+			handle = static_cast<Handle>(m_proxies.size());
+			m_proxies.emplace_back();
+		}
+
+		auto& proxy = m_proxies[handle];
+		proxy.box = box;
+		proxy.cells = getCellRange(box);
+		proxy.userData = userData;
+		proxy.queryStamp = 0;
+		proxy.nextFree = INVALID;
+		proxy.active = true;
+
+		link(handle);
+		m_proxyCount++;
+
+		return handle;
+	}
+
+	void SpatialHashGrid::move(Handle handle, const BoundingBox& box)
+	{
+		auto& proxy = m_proxies[handle];
+		assert(proxy.active);
+
+		proxy.box = box;
+
+		auto cells = getCellRange(box);
+		if (cells == proxy.cells) return;
+
+		unlink(handle);
+		proxy.cells = cells;
+		link(handle);
+	}
+
+	void SpatialHashGrid::remove(Handle handle)
+	{
+		if (handle == INVALID || handle >= m_proxies.size() || !m_proxies[handle].active) return;
+
+		unlink(handle);
+
+		auto& proxy = m_proxies[handle];
+		proxy.active = false;
+		proxy.nextFree = m_freeProxy;
+		m_freeProxy = handle;
+		m_proxyCount--;
+	}
+
+	void SpatialHashGrid::clear()
+	{
+		std::fill(m_buckets.begin(), m_buckets.end(), INVALID);
+		m_entries.clear();
+		m_proxies.clear();
+		m_oversized.clear();
+		m_freeEntry = INVALID;
+		m_freeProxy = INVALID;
+		m_entryCount = 0;
+		m_proxyCount = 0;
+	}
+
+	void SpatialHashGrid::query(const BoundingBox& box, std::vector<uint32_t>& out)
+	{
+		if (!box.isValid || !isFinite(box.min) || !isFinite(box.max)) return;
+
+		auto accept = [&](const Proxy& proxy) { return proxy.box.intersects(box); };
+		auto range = getCellRange(box);
+
+		// more cells than entries; most of them are empty, and looking at everything is cheaper
+		if (range.count() > static_cast<double>(m_entryCount)) {
+			gatherAll(accept, out);
+			return;
+		}
+
+		nextQueryStamp();
+
+		for (int z = range.minZ; z <= range.maxZ; z++) {
+			for (int y = range.minY; y <= range.maxY; y++) {
+				for (int x = range.minX; x <= range.maxX; x++) {
+					gatherCell(x, y, z, accept, out);
+				}
+			}
+		}
+
+		gatherOversized(accept, out);
+	}
+
+	void SpatialHashGrid::queryRay(const Vec3& from, const Vec3& to, std::vector<uint32_t>& out)
+	{
+		if (!isFinite(from) || !isFinite(to)) return;
+
+		const Vec3 path = to - from;
+		auto accept = [&](const Proxy& proxy) { return segmentHitsBox(proxy.box, from, path); };
+
+		// the walk crosses one cell boundary at a time, so it visits at most this many cells
+		BoundingBox bounds;
+		bounds.extend(from);
+		bounds.extend(to);
+		auto range = getCellRange(bounds);
+
+		int64_t cellCount = int64_t(range.maxX) - range.minX + int64_t(range.maxY) - range.minY + int64_t(range.maxZ) - range.minZ + 1;
+		if (cellCount > static_cast<int64_t>(m_entryCount)) {
+			gatherAll(accept, out);
+			return;
+		}
+
+		nextQueryStamp();
+
+		// DDA: from the cell the segment starts in, step into whichever neighbour it reaches first. tMax is how far along
+		// the segment (0 to 1) the next boundary on each axis is, tDelta how far it is across a whole cell
+		int cell[3] = { toCell(from.x), toCell(from.y), toCell(from.z) };
+		int step[3];
+		float tMax[3];
+		float tDelta[3];
+
+		for (int axis = 0; axis < 3; axis++) {
+			if (path[axis] > 0.f) {
+				step[axis] = 1;
+				tMax[axis] = ((cell[axis] + 1) * m_cellSize - from[axis]) / path[axis];
+				tDelta[axis] = m_cellSize / path[axis];
+			}
+			else if (path[axis] < 0.f) {
+				step[axis] = -1;
+				tMax[axis] = (cell[axis] * m_cellSize - from[axis]) / path[axis];
+				tDelta[axis] = -m_cellSize / path[axis];
+			}
+			else {
+				step[axis] = 0;
+				tMax[axis] = tDelta[axis] = std::numeric_limits<float>::infinity();
+			}
+		}
+
+		for (int64_t i = 0; i < cellCount; i++) {
+			gatherCell(cell[0], cell[1], cell[2], accept, out);
+
+			int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+			if (tMax[axis] > 1.f) break;
+
+			cell[axis] += step[axis];
+			tMax[axis] += tDelta[axis];
+		}
+
+		gatherOversized(accept, out);
+	}
+
+	SpatialHashGrid::CellRange SpatialHashGrid::getCellRange(const BoundingBox& box) const
+	{
+		// an invalid or non-finite box doesn't occupy any cells
+		if (!box.isValid || !isFinite(box.min) || !isFinite(box.max)) return { 1, 1, 1, 0, 0, 0 };
+
+		return {
+			toCell(box.min.x), toCell(box.min.y), toCell(box.min.z),
+			toCell(box.max.x), toCell(box.max.y), toCell(box.max.z)
+		};
+	}
+
+	void SpatialHashGrid::nextQueryStamp()
+	{
+		// on the (very) rare wrap, reset everyone so old stamps can't match
+		if (++m_queryStamp == 0) {
+			for (auto& proxy : m_proxies) proxy.queryStamp = 0;
+			m_queryStamp = 1;
+		}
+	}
+
+	template<typename Accept>
+	void SpatialHashGrid::gatherCell(int x, int y, int z, Accept&& accept, std::vector<uint32_t>& out)
+	{
+		for (uint32_t e = m_buckets[hash(x, y, z)]; e != INVALID; e = m_entries[e].next) {
+			const auto& entry = m_entries[e];
+			if (entry.x != x || entry.y != y || entry.z != z) continue;
+
+			auto& proxy = m_proxies[entry.proxy];
+			if (proxy.queryStamp == m_queryStamp) continue;
+			proxy.queryStamp = m_queryStamp;
+
+			if (accept(proxy)) {
+				out.push_back(proxy.userData);
+			}
+		}
+	}
+
+	template<typename Accept>
+	void SpatialHashGrid::gatherOversized(Accept&& accept, std::vector<uint32_t>& out) const
+	{
+		// never linked into any cell, so they can't have been reported already
+		for (Handle h : m_oversized) {
+			if (accept(m_proxies[h])) {
+				out.push_back(m_proxies[h].userData);
+			}
+		}
+	}
+
+	template<typename Accept>
+	void SpatialHashGrid::gatherAll(Accept&& accept, std::vector<uint32_t>& out) const
+	{
+		for (const auto& proxy : m_proxies) {
+			if (proxy.active && !proxy.cells.empty() && accept(proxy)) {
+				out.push_back(proxy.userData);
+			}
+		}
+	}
+
+	int SpatialHashGrid::toCell(float v) const
+	{
+		// keep well inside int range so the cast is always defined; written so NaN lands on the low end rather than
+		// passing through
+		float cell = v * m_invCellSize;
+		if (!(cell > -1.0e9f)) cell = -1.0e9f;
+		if (!(cell < 1.0e9f)) cell = 1.0e9f;
+		return static_cast<int>(std::floor(cell));
+	}
+
+	size_t SpatialHashGrid::hash(int x, int y, int z) const
+	{
+		uint32_t h = (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u) ^ (static_cast<uint32_t>(z) * 83492791u);
+		return h & (m_buckets.size() - 1);
+	}
+
+	void SpatialHashGrid::link(Handle handle)
+	{
+		auto& proxy = m_proxies[handle];
+		const auto& range = proxy.cells;
+
+		if (range.count() > static_cast<double>(MAX_PROXY_CELLS)) {
+			proxy.oversized = static_cast<uint32_t>(m_oversized.size());
+			m_oversized.push_back(handle);
+			return;
+		}
+
+		for (int z = range.minZ; z <= range.maxZ; z++) {
+			for (int y = range.minY; y <= range.maxY; y++) {
+				for (int x = range.minX; x <= range.maxX; x++) {
+					// keep the buckets from getting too crowded
+					if (m_entryCount >= m_buckets.size() * 2) {
+						rehash(m_buckets.size() * 2);
+					}
+
+					uint32_t e;
+					if (m_freeEntry != INVALID) {
+						e = m_freeEntry;
+						m_freeEntry = m_entries[e].next;
+					}
+					else {
+						e = static_cast<uint32_t>(m_entries.size());
+						m_entries.emplace_back();
+					}
+
+					size_t bucket = hash(x, y, z);
+					m_entries[e] = { x, y, z, handle, m_buckets[bucket] };
+					m_buckets[bucket] = e;
+					m_entryCount++;
+				}
+			}
+		}
+	}
+
+	void SpatialHashGrid::unlink(Handle handle)
+	{
+		auto& proxy = m_proxies[handle];
+		const auto& range = proxy.cells;
+
+		// swap the last one into our slot
+		if (proxy.oversized != INVALID) {
+			Handle last = m_oversized.back();
+			m_oversized[proxy.oversized] = last;
+			m_proxies[last].oversized = proxy.oversized;
+			m_oversized.pop_back();
+			proxy.oversized = INVALID;
+			return;
+		}
+
+		for (int z = range.minZ; z <= range.maxZ; z++) {
+			for (int y = range.minY; y <= range.maxY; y++) {
+				for (int x = range.minX; x <= range.maxX; x++) {
+					uint32_t* prev = &m_buckets[hash(x, y, z)];
+
+					while (*prev != INVALID) {
+						auto& entry = m_entries[*prev];
+
+						if (entry.proxy == handle && entry.x == x && entry.y == y && entry.z == z) {
+							uint32_t e = *prev;
+							*prev = entry.next;
+
+							entry.next = m_freeEntry;
+							m_freeEntry = e;
+							m_entryCount--;
+							break;
+						}
+
+						prev = &entry.next;
+					}
+				}
+			}
+		}
+	}
+
+	void SpatialHashGrid::rehash(size_t bucketCount)
+	{
+		std::vector<uint32_t> live;
+		live.reserve(m_entryCount);
+
+		for (uint32_t head : m_buckets) {
+			for (uint32_t e = head; e != INVALID; e = m_entries[e].next) {
+				live.push_back(e);
+			}
+		}
+
+		m_buckets.assign(bucketCount, INVALID);
+
+		for (uint32_t e : live) {
+			size_t bucket = hash(m_entries[e].x, m_entries[e].y, m_entries[e].z);
+			m_entries[e].next = m_buckets[bucket];
+			m_buckets[bucket] = e;
+		}
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "Math/Math.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace wf
+{
+	/**
+	 * @brief Unbounded uniform grid, hashed on integer cell coordinates.
+	 *
+	 * Boxes are registered in every cell they overlap. Cells live in a fixed number of hash buckets, so the world has no
+	 * bounds; different cells landing in the same bucket are told apart by their coordinates. Proxies and cell entries are
+	 * pooled with free lists, so once the pools and the bucket table have grown to fit there are no further allocations.
+	 *
+	 * A box covering more than MAX_PROXY_CELLS cells goes on an oversized list instead, which every query checks
+	 * linearly, so one huge box can't flood the table. Boxes that aren't finite occupy no cells and are never reported.
+	 *
+	 * Each proxy carries a 32-bit user value (typically an entity ID) which is what the queries hand back.
+	 *
+	 * Not thread safe, queries included: they stamp each proxy they report so it's only reported once, so two queries at
+	 * the same time would trip over each other. Query from one thread at a time, and not while anything's being moved.
+	 */
+	class SpatialHashGrid
+	{
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle INVALID = UINT32_MAX;
+		static constexpr size_t MAX_PROXY_CELLS = 64;				// more than this and a proxy goes on the oversized list
+
+		SpatialHashGrid(float cellSize = 4.f, size_t bucketCount = 1024);
+		~SpatialHashGrid() = default;
+
+		/**
+		 * @brief Change the cell size. Everything already in the grid is re-registered
+		 */
+		void setCellSize(float cellSize);
+		float getCellSize() const { return m_cellSize; }
+
+		/**
+		 * @brief Register a box. The returned handle is stable until it's removed
+		 */
+		Handle insert(const BoundingBox& box, uint32_t userData);
+
+		/**
+		 * @brief Update the box for a proxy. Only touches the cells if the box has moved into different ones
+		 */
+		void move(Handle handle, const BoundingBox& box);
+
+		/**
+		 * @brief Unregister a proxy. The handle may be reused by a later insert
+		 */
+		void remove(Handle handle);
+
+		/**
+		 * @brief Remove everything, keeping the allocated storage
+		 */
+		void clear();
+
+		/**
+		 * @brief Gather the user data for each proxy whose box overlaps the given one. Each proxy is reported once.
+		 *
+		 * A box covering more cells than there are entries in the grid scans the proxies instead, so a huge query costs no
+		 * more than looking at everything.
+		 */
+		void query(const BoundingBox& box, std::vector<uint32_t>& out);
+
+		/**
+		 * @brief Gather the user data for each proxy whose box the segment passes through, walking only the cells along
+		 * it. Each proxy is reported once, in no particular order
+		 */
+		void queryRay(const Vec3& from, const Vec3& to, std::vector<uint32_t>& out);
+
+		uint32_t getUserData(Handle handle) const { return m_proxies[handle].userData; }
+		const BoundingBox& getBox(Handle handle) const { return m_proxies[handle].box; }
+		size_t size() const { return m_proxyCount; }
+
+	private:
+		struct CellRange
+		{
+			int minX, minY, minZ;
+			int maxX, maxY, maxZ;
+
+			bool operator==(const CellRange& other) const = default;
+			bool empty() const { return minX > maxX; }
+			double count() const { return empty() ? 0.0 : (double(maxX) - minX + 1) * (double(maxY) - minY + 1) * (double(maxZ) - minZ + 1); }
+		};
+
+		struct Proxy
+		{
+			BoundingBox box;
+			CellRange cells{};
+			uint32_t userData{ 0 };
+			uint32_t queryStamp{ 0 };								// last query that reported this, to avoid duplicates
+			uint32_t nextFree{ INVALID };
+			uint32_t oversized{ INVALID };							// index in the oversized list, if it's on it
+			bool active{ false };
+		};
+
+		struct Entry
+		{
+			int x, y, z;											// cell coordinates
+			Handle proxy;
+			uint32_t next;											// next entry in the bucket, or next free entry
+		};
+
+	private:
+		CellRange getCellRange(const BoundingBox& box) const;
+		void nextQueryStamp();
+		template<typename Accept>
+		void gatherCell(int x, int y, int z, Accept&& accept, std::vector<uint32_t>& out);
+		template<typename Accept>
+		void gatherOversized(Accept&& accept, std::vector<uint32_t>& out) const;
+		template<typename Accept>
+		void gatherAll(Accept&& accept, std::vector<uint32_t>& out) const;
+		int toCell(float v) const;
+		size_t hash(int x, int y, int z) const;
+		void link(Handle handle);
+		void unlink(Handle handle);
+		void rehash(size_t bucketCount);
+
+	private:
+		float m_cellSize{ 4.f };
+		float m_invCellSize{ .25f };
+
+		std::vector<uint32_t> m_buckets;							// head entry per bucket; size is a power of 2
+		std::vector<Entry> m_entries;
+		std::vector<Proxy> m_proxies;
+		std::vector<Handle> m_oversized;							// proxies covering too many cells to link
+
+		uint32_t m_freeEntry{ INVALID };
+		Handle m_freeProxy{ INVALID };
+		size_t m_entryCount{ 0 };
+		size_t m_proxyCount{ 0 };
+		uint32_t m_queryStamp{ 0 };
+	};
+}
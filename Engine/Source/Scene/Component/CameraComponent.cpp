@@ -65,6 +65,39 @@ namespace wf
 		return getProjectionMatrix() * getViewMatrix();
 	}
 
+	bool CameraComponent::canSee(const BoundingBox& box) const
+	{
+		if (!box.isValid) return false;
+
+		const glm::mat4 viewProj = getViewProjectionMatrix().matrix;
+
+		// the box is only hidden if every corner is beyond the same clip plane
+		int outside[6] = {};
+
+		for (int i = 0; i < 8; i++) {
+			Vec3 corner = {
+				(i & 1) ? box.max.x : box.min.x,
+				(i & 2) ? box.max.y : box.min.y,
+				(i & 4) ? box.max.z : box.min.z
+			};
+
+			Vec4 clip = viewProj * Vec4(corner, 1.f);
+
+			if (clip.x < -clip.w) outside[0]++;
+			if (clip.x > clip.w) outside[1]++;
+			if (clip.y < -clip.w) outside[2]++;
+			if (clip.y > clip.w) outside[3]++;
+			if (clip.z < -clip.w) outside[4]++;
+			if (clip.z > clip.w) outside[5]++;
+		}
+
+		for (int plane = 0; plane < 6; plane++) {
+			if (outside[plane] == 8) return false;
+		}
+
+		return true;
+	}
+
 	Vec3 CameraComponent::getForward() const
 	{
 		return glm::normalize(target - position);
@@ -28,6 +28,11 @@ namespace wf
 		Mat4 getProjectionMatrix() const;
 		Mat4 getViewProjectionMatrix() const;
 
+		/**
+		 * @brief Whether any of the box might be in view. Conservative; a box near a frustum corner can count as visible
+		 */
+		bool canSee(const BoundingBox& box) const;
+
 		Vec3 getForward() const;
 		Vec3 getUp() const;
 		Vec3 getRight() const;
@@ -0,0 +1,15 @@
+#pragma once
+#include "Math/Math.h"
+
+namespace wf
+{
+	/**
+	 * @brief Where the entity was as of the previous fixed step.
+	 *
+	 * For anything moved in fixedUpdate(). The scene keeps it up to date before each fixed step, and the render draws
+	 * between the two by how far real time has got through the next one, so motion stays smooth whatever the step rate.
+	 */
+	struct PreviousTransformComponent : public Transform
+	{
+	};
+}
@@ -3,6 +3,7 @@
 
 #include "Component/CameraComponent.h"
 #include "Component/LightComponent.h"
+#include "Component/PreviousTransformComponent.h"
 #include "Component/TransformComponent.h"
 
 namespace wf
@@ -50,6 +51,12 @@ namespace wf
 
 	void Scene::fixedUpdate(float dt)
 	{
+		// the step about to run becomes the one drawn from
+		entityManager.each<TransformComponent, PreviousTransformComponent>(
+			[&](const TransformComponent& transform, PreviousTransformComponent& previous) {
+				static_cast<Transform&>(previous) = transform;
+			});
+
 		for (auto& system : m_systems) {
 			system->fixedUpdate(dt);
 		}
@@ -59,6 +59,18 @@ namespace wf
 		 */
 		virtual void fixedUpdate(float dt);
 
+		/**
+		 * @brief Invoked once the frame's updates are done and before it's drawn. Anything that can run alongside the render
+		 * and the wait for vsync can be set going here
+		 */
+		virtual void launchBackgroundWork() {}
+
+		/**
+		 * @brief Invoked once the frame has been drawn. Anything set going in launchBackgroundWork() has to be finished by
+		 * the time this returns, ready for the next frame's updates
+		 */
+		virtual void syncBackgroundWork() {}
+
 		/**
 		 * @brief Render the scene
 		 */
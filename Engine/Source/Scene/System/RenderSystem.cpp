@@ -6,6 +6,7 @@
 #include "Scene/Component/CameraComponent.h"
 #include "Scene/Component/LightComponent.h"
 #include "Scene/Component/MeshRendererComponent.h"
+#include "Scene/Component/PreviousTransformComponent.h"
 #include "Scene/Component/TransformComponent.h"
 
 namespace wf::system
@@ -25,12 +26,20 @@ namespace wf::system
 						meshRenderer.mesh->buffers = wgl::createMeshBuffers();
 
 						wgl::uploadMeshData(meshRenderer.mesh->buffers, meshRenderer.mesh->vertices, meshRenderer.mesh->indices, meshRenderer.mesh->isDynamic);
+
+						// from here on, positions are written straight into the stream by whoever moves them
+						if (meshRenderer.mesh->streamPositions) {
+							meshRenderer.mesh->stream = wgl::createVertexStream(meshRenderer.mesh->buffers, meshRenderer.mesh->vertices);
+						}
+						meshRenderer.mesh->needsUpdate = false;
 					}
 				}
 				else {
-					// update the mesh data
-					if (meshRenderer.mesh->isDynamic && (meshRenderer.mesh->needsUpdate || meshRenderer.mesh->autoUpdate)) {
+					// update the mesh data. with a stream, the positions are already there, so only an explicit update counts
+					const bool streamed = meshRenderer.mesh->stream.buffer != 0;
+					if (meshRenderer.mesh->isDynamic && (meshRenderer.mesh->needsUpdate || (meshRenderer.mesh->autoUpdate && !streamed))) {
 						wgl::updateMeshData(meshRenderer.mesh->buffers, meshRenderer.mesh->vertices, meshRenderer.mesh->indices);
+						meshRenderer.mesh->needsUpdate = false;
 					}
 				}
 			});
@@ -56,8 +65,11 @@ namespace wf::system
 	{
 		wgl::clearColour(scene->getBackgroundColour(), true);
 
+		const float alpha = getFixedAlpha();
+		auto& registry = entityManager->getRegistry();
+
 		entityManager->each<MeshRendererComponent, TransformComponent>(
-			[&](const MeshRendererComponent& meshRenderer, const TransformComponent& transform) {
+			[&](EntityID id, const MeshRendererComponent& meshRenderer, const TransformComponent& transform) {
 
 				auto& material = meshRenderer.material;
 
@@ -65,15 +77,26 @@ namespace wf::system
 				if (!meshRenderer.mesh || !meshRenderer.mesh->buffers.vao) return;
 				if (!material.shader.handle.glId) return;
 
+				// anything moved by the fixed steps is drawn between the last two of them
+				Transform shown = transform;
+				if (const auto* previous = registry.try_get<PreviousTransformComponent>(id)) {
+					shown = Transform::interpolate(*previous, transform, alpha);
+				}
+
 				RenderContext ctx(scene->getCurrentCamera(), scene->getCurrentLight());
-				material.bind(ctx, transform);
+				material.bind(ctx, shown);
+
+				auto& mesh = *meshRenderer.mesh;
+				wgl::bindVertexStream(mesh.buffers, mesh.stream);
 
 				wgl::drawMeshBuffers(
-					meshRenderer.mesh->buffers,
-					static_cast<int>(meshRenderer.mesh->vertices.size()),
-					static_cast<int>(meshRenderer.mesh->indices.size()),
+					mesh.buffers,
+					static_cast<int>(mesh.vertices.size()),
+					static_cast<int>(mesh.indices.size()),
 					material.wireframe
 				);
+
+				wgl::fenceVertexStream(mesh.stream);
 			});
 	}
 
@@ -98,6 +121,8 @@ namespace wf::system
 				}
 
 				// delete the VAO/VBOs
+				if (!meshRenderer.mesh) return;
+				wgl::destroyVertexStream(meshRenderer.mesh->stream);
 				if (meshRenderer.mesh->buffers.vao) {
 					wgl::destroyMeshBuffers(meshRenderer.mesh->buffers);
 					meshRenderer.mesh->buffers = {};
@@ -0,0 +1,85 @@
+#include "EdgeList.h"
+#include "Utils/Lanes.h"
+
+#include <cmath>
+
+namespace Squishies::Component
+{
+	void EdgeList::resize(size_t count)
+	{
+		size_t padded = padForLoads(count);
+
+		for (auto* arr : { &p1X, &p1Y, &p2X, &p2Y, &dirX, &dirY, &normalX, &normalY, &length }) {
+			arr->resize(padded, 0.f);
+		}
+
+		m_count = count;
+
+		for (size_t i = m_count; i < padded; i++) {
+			p1X[i] = p1Y[i] = p2X[i] = p2Y[i] = 0.f;
+			dirX[i] = dirY[i] = normalX[i] = normalY[i] = 0.f;
+			length[i] = 0.f;
+		}
+	}
+
+	void EdgeList::set(size_t i, const wf::Vec2& p1, const wf::Vec2& p2)
+	{
+		p1X[i] = p1.x;
+		p1Y[i] = p1.y;
+		p2X[i] = p2.x;
+		p2Y[i] = p2.y;
+
+		float dx = p2.x - p1.x;
+		float dy = p2.y - p1.y;
+		float len = std::sqrt(dx * dx + dy * dy);
+
+		length[i] = len;
+
+		// a collapsed edge has no direction; leave it zeroed so queries just see its end point
+		if (len > EPSILON) {
+			dirX[i] = dx / len;
+			dirY[i] = dy / len;
+		}
+		else {
+			dirX[i] = dirY[i] = 0.f;
+		}
+
+		normalX[i] = dirY[i];
+		normalY[i] = -dirX[i];
+	}
+
+	wf::BoundingBox EdgeList::setOutline(const std::vector<wf::Vec2>& points, const wf::Transform& transform, bool closed)
+	{
+		const size_t pointCount = points.size();
+		resize(closed ? pointCount : (pointCount > 0 ? pointCount - 1 : 0));
+
+		wf::BoundingBox bounds;
+		if (points.empty()) return bounds;
+
+		// one matrix for the whole outline, and each point transformed once
+		const auto m = transform.getTransformMatrix().matrix;
+		auto toWorld = [&](const wf::Vec2& p) {
+			glm::vec4 world = m * glm::vec4(p.x, p.y, 0.f, 1.f);
+			return wf::Vec2(world.x, world.y);
+		};
+
+		const wf::Vec2 first = toWorld(points[0]);
+		wf::Vec2 prev = first;
+		bounds.extend(wf::Vec3(first, 0.f));
+		bounds.extend(wf::Vec3(first, BOUNDS_DEPTH));
+
+		for (size_t i = 1; i < pointCount; i++) {
+			const wf::Vec2 pt = toWorld(points[i]);
+			set(i - 1, prev, pt);
+			bounds.extend(wf::Vec3(pt, 0.f));
+			bounds.extend(wf::Vec3(pt, BOUNDS_DEPTH));
+			prev = pt;
+		}
+
+		if (closed) {
+			set(pointCount - 1, prev, first);
+		}
+
+		return bounds;
+	}
+}
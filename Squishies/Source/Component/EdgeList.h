@@ -0,0 +1,56 @@
+#pragma once
+#include "Engine.h"
+
+#include <vector>
+
+namespace Squishies::Component
+{
+	constexpr float BOUNDS_DEPTH = .1f;								// z extent of the bodies' bounding boxes, so boxes in the plane overlap
+
+	/**
+	 * @brief Structure-of-arrays storage for the outline edges of a soft body (2D, XY)
+	 *
+	 * Edge i runs from point i to point i + 1 (wrapping). Alongside the end points we keep the unit direction, the
+	 * perpendicular normal and the length, so the collision kernels never need to re-derive them per query.
+	 *
+	 * Arrays are padded with padForLoads(). Padding is zeroed and never counted; the kernels mask it off.
+	 */
+	struct EdgeList
+	{
+		std::vector<float> p1X, p1Y;								// start point
+		std::vector<float> p2X, p2Y;								// end point
+		std::vector<float> dirX, dirY;								// unit direction, p1 towards p2
+		std::vector<float> normalX, normalY;						// perpendicular to the direction (dir rotated clockwise)
+		std::vector<float> length;
+
+		/**
+		 * @brief Number of actual edges (excluding padding)
+		 */
+		size_t size() const { return m_count; }
+		bool empty() const { return m_count == 0; }
+
+		/**
+		 * @brief Resize the store, keeping the padding zeroed
+		 */
+		void resize(size_t count);
+
+		/**
+		 * @brief Set an edge from its end points, deriving the rest
+		 */
+		void set(size_t i, const wf::Vec2& p1, const wf::Vec2& p2);
+
+		/**
+		 * @brief Set every edge from an outline placed in the world by a transform, joining the last point back to the
+		 * first if it's closed. Returns the world space bounds, BOUNDS_DEPTH deep
+		 */
+		wf::BoundingBox setOutline(const std::vector<wf::Vec2>& points, const wf::Transform& transform, bool closed);
+
+		wf::Vec2 getP1(size_t i) const { return { p1X[i], p1Y[i] }; }
+		wf::Vec2 getP2(size_t i) const { return { p2X[i], p2Y[i] }; }
+		wf::Vec2 getDir(size_t i) const { return { dirX[i], dirY[i] }; }
+		wf::Vec2 getNormal(size_t i) const { return { normalX[i], normalY[i] }; }
+
+	private:
+		size_t m_count{ 0 };
+	};
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "Engine.h"
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief Ground that soft bodies collide against, as a grid of heights; e.g. a generated terrain.
+	 *
+	 * Either fill in the field directly (Heightfield::generate from the same noise as the terrain), or leave it empty and
+	 * it's built from the entity's mesh when added, offset by the transform's position. Rotation and scale aren't
+	 * accounted for. While there's one about, it takes the place of the floor of the world bounds.
+	 */
+	struct HeightfieldCollider
+	{
+		wf::Heightfield field;										// world space heights
+	};
+}
@@ -0,0 +1,57 @@
+#include "JointList.h"
+#include "Utils/Lanes.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Squishies::Component
+{
+	void JointList::build(const std::vector<Joint>& joints, size_t pointCount)
+	{
+		// order by the lower end so that runs of joints walk through the points; springs are symmetric so swapping the
+		// ends changes nothing
+		std::vector<Joint> sorted;
+		sorted.reserve(joints.size());
+
+		for (const auto& joint : joints) {
+			if (joint.from >= pointCount || joint.to >= pointCount || joint.from == joint.to) continue;
+			sorted.push_back({ std::min(joint.from, joint.to), std::max(joint.from, joint.to), joint.rest });
+		}
+
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Joint& a, const Joint& b) {
+			return a.from != b.from ? a.from < b.from : a.to < b.to;
+			});
+
+		// greedy colouring: each joint takes the first batch neither of its points is in yet
+		std::vector<uint32_t> colour(sorted.size());
+		std::vector<std::vector<bool>> used;						// per batch, per point
+
+		for (size_t j = 0; j < sorted.size(); j++) {
+			size_t c = 0;
+			while (c < used.size() && (used[c][sorted[j].from] || used[c][sorted[j].to])) c++;
+
+			if (c == used.size()) used.emplace_back(pointCount, false);
+
+			used[c][sorted[j].from] = used[c][sorted[j].to] = true;
+			colour[j] = static_cast<uint32_t>(c);
+		}
+
+		// lay the batches out one after the other, keeping the sorted order within each
+		batchStart.assign(used.size() + 1, 0);
+		for (uint32_t c : colour) batchStart[c + 1]++;
+		std::partial_sum(batchStart.begin(), batchStart.end(), batchStart.begin());
+
+		const size_t padded = padForLoads(sorted.size());
+		p1.assign(padded, 0);
+		p2.assign(padded, 0);
+		rest.assign(padded, 0.f);
+
+		std::vector<uint32_t> next(batchStart.begin(), batchStart.end() - 1);
+		for (size_t j = 0; j < sorted.size(); j++) {
+			uint32_t slot = next[colour[j]]++;
+			p1[slot] = static_cast<uint32_t>(sorted[j].from);
+			p2[slot] = static_cast<uint32_t>(sorted[j].to);
+			rest[slot] = sorted[j].rest;
+		}
+	}
+}
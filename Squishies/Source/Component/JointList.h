@@ -0,0 +1,40 @@
+#pragma once
+#include "Poly/Squishy.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief Compiled joints of a soft body, packed for the solvers (SoA)
+	 *
+	 * Joints are sorted by their lower point index so neighbouring joints touch neighbouring points, then coloured into
+	 * batches in which no point appears twice. A batch can be evaluated a vector's worth at a time and its results added
+	 * back to the points without two lanes writing to the same one.
+	 *
+	 * Arrays are padded with padForLoads(). Padding joins point 0 to itself and is never counted.
+	 */
+	struct JointList
+	{
+		std::vector<uint32_t> p1, p2;								// point indices, p1 < p2
+		std::vector<float> rest;									// rest length
+		std::vector<uint32_t> batchStart;							// batch b is [batchStart[b], batchStart[b + 1])
+
+		/**
+		 * @brief Number of actual joints (excluding padding)
+		 */
+		size_t size() const { return batchStart.empty() ? 0 : batchStart.back(); }
+		bool empty() const { return size() == 0; }
+
+		/**
+		 * @brief Number of conflict-free batches
+		 */
+		size_t batchCount() const { return batchStart.empty() ? 0 : batchStart.size() - 1; }
+
+		/**
+		 * @brief Compile from a shape's joints
+		 */
+		void build(const std::vector<Joint>& joints, size_t pointCount);
+	};
+}
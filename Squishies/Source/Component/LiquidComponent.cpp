@@ -0,0 +1,36 @@
+#include "LiquidComponent.h"
+#include "Component/EdgeList.h"
+
+namespace Squishies::Component
+{
+	void Liquid::addParticle(const wf::Vec2& position, const wf::Vec2& velocity)
+	{
+		posX.push_back(position.x);
+		posY.push_back(position.y);
+		velX.push_back(velocity.x);
+		velY.push_back(velocity.y);
+
+		boundingBox.extend(wf::Vec3(position, 0.f));
+		boundingBox.extend(wf::Vec3(position, BOUNDS_DEPTH));
+	}
+
+	void Liquid::fillRect(const wf::Vec2& min, const wf::Vec2& max, const wf::Vec2& velocity)
+	{
+		const float spacing = getSpacing();
+
+		for (float y = min.y + particleRadius; y <= max.y - particleRadius; y += spacing) {
+			for (float x = min.x + particleRadius; x <= max.x - particleRadius; x += spacing) {
+				addParticle({ x, y }, velocity);
+			}
+		}
+	}
+
+	void Liquid::clear()
+	{
+		posX.clear();
+		posY.clear();
+		velX.clear();
+		velY.clear();
+		boundingBox.reset();
+	}
+}
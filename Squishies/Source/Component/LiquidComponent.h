@@ -0,0 +1,60 @@
+#pragma once
+#include "Engine.h"
+
+#include <vector>
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief A body of liquid, as particles (SoA), simulated by the LiquidSystem.
+	 *
+	 * Particles live in world space on the same plane as the soft bodies. Their order isn't stable; the system shuffles
+	 * them every step so that neighbours sit together in memory. Give the entity a Collider in the LIQUID group to
+	 * choose what it pours over, and a MeshRenderer to see it; leave the entity at the origin, as the mesh is built from
+	 * the particles' world positions.
+	 */
+	struct Liquid
+	{
+		std::vector<float> posX, posY;								// particle positions
+		std::vector<float> velX, velY;								// particle velocities
+
+		float particleRadius{ .05f };								// half the spacing at rest
+		float particleMass{ .05f };									// per particle, as far as the soft bodies are concerned
+		float viscosity{ .05f };									// 0 - 1, how much each particle takes on its neighbours' velocity per step
+		float relaxation{ .01f };									// softens the density solve; higher is squishier but steadier
+		uint32_t iterations{ 3 };									// density solver iterations per step
+		wf::Colour colour{ wf::BLUE };
+
+		wf::BoundingBox boundingBox{};								// around all of the particles, as of the last step
+
+		/**
+		 * @brief How many particles there are
+		 */
+		size_t size() const { return posX.size(); }
+
+		/**
+		 * @brief Distance between particles at rest
+		 */
+		float getSpacing() const { return particleRadius * 2.f; }
+
+		/**
+		 * @brief How far particles feel each other. Also the size of the neighbour grid's cells
+		 */
+		float getKernelRadius() const { return getSpacing() * 2.f; }
+
+		/**
+		 * @brief Add a single particle
+		 */
+		void addParticle(const wf::Vec2& position, const wf::Vec2& velocity = {});
+
+		/**
+		 * @brief Fill a rectangle with particles at rest spacing
+		 */
+		void fillRect(const wf::Vec2& min, const wf::Vec2& max, const wf::Vec2& velocity = {});
+
+		/**
+		 * @brief Remove all particles
+		 */
+		void clear();
+	};
+}
@@ -0,0 +1,67 @@
+#include "PointMasses.h"
+#include "Utils/Lanes.h"
+
+#include <algorithm>
+
+namespace Squishies::Component
+{
+	void PointMasses::resize(size_t count)
+	{
+		size_t oldPadded = paddedSize();
+		size_t padded = padToLanes(count);
+
+		for (auto* arr : { &posX, &posY, &posZ, &velX, &velY, &velZ, &forceX, &forceY, &forceZ, &lastX, &lastY, &lastZ, &globalX, &globalY, &globalZ }) {
+			arr->resize(padded, 0.f);
+		}
+		mass.resize(padded, 1.f);
+		invMass.resize(padded, 1.f);
+		flags.resize(padded, NONE);
+
+		// anything that was padding but is now a real point gets sensible defaults
+		for (size_t i = m_count; i < std::min(count, oldPadded); i++) {
+			setMass(i, 1.f);
+			flags[i] = NONE;
+		}
+
+		m_count = count;
+
+		// and the padding itself is inert
+		for (size_t i = m_count; i < padded; i++) {
+			posX[i] = posY[i] = posZ[i] = 0.f;
+			velX[i] = velY[i] = velZ[i] = 0.f;
+			forceX[i] = forceY[i] = forceZ[i] = 0.f;
+			invMass[i] = 0.f;
+			flags[i] = FIXED;
+		}
+	}
+
+	void PointMasses::setVelocities(const wf::Vec3& v)
+	{
+		std::fill(velX.begin(), velX.begin() + m_count, v.x);
+		std::fill(velY.begin(), velY.begin() + m_count, v.y);
+		std::fill(velZ.begin(), velZ.begin() + m_count, v.z);
+	}
+
+	void PointMasses::addForces(const wf::Vec3& f)
+	{
+		for (size_t i = 0; i < m_count; i++) {
+			forceX[i] += f.x;
+			forceY[i] += f.y;
+			forceZ[i] += f.z;
+		}
+	}
+
+	void PointMasses::clearForces()
+	{
+		std::fill(forceX.begin(), forceX.end(), 0.f);
+		std::fill(forceY.begin(), forceY.end(), 0.f);
+		std::fill(forceZ.begin(), forceZ.end(), 0.f);
+	}
+
+	void PointMasses::clearInsideAnother()
+	{
+		for (auto& f : flags) {
+			f &= ~INSIDE_ANOTHER;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "Engine.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief Structure-of-arrays storage for the point masses of a soft body
+	 *
+	 * The hot data (position, velocity, force, inverse mass and flags) each live in their own contiguous per-axis arrays,
+	 * so the integrator and constraint passes only stream the bytes they actually touch. The colder data (last/global
+	 * positions, mass) is kept in separate arrays alongside.
+	 *
+	 * All arrays are padded with padToLanes() so that vector loops can run over whole lanes without a scalar tail.
+	 * Padding entries are zeroed, have no inverse mass and are flagged as fixed, so they're inert if processed.
+	 */
+	struct PointMasses
+	{
+		enum Flags : uint8_t
+		{
+			NONE = 0,
+			FIXED = 1,												// fixed point; cannot move
+			INSIDE_ANOTHER = 2,										// collision detection picked up that this point is inside another object
+		};
+
+		// hot
+		std::vector<float> posX, posY, posZ;						// point positions
+		std::vector<float> velX, velY, velZ;						// current velocity for the points
+		std::vector<float> forceX, forceY, forceZ;					// all forces (external & internal) applied
+		std::vector<float> invMass;									// 1 / mass, or 0 for infinite mass
+		std::vector<uint8_t> flags;									// see Flags
+
+		// cold
+		std::vector<float> mass;									// point mass
+		std::vector<float> lastX, lastY, lastZ;						// keeping tabs on last position for stability
+		std::vector<float> globalX, globalY, globalZ;				// after transforming the original using derived vals
+
+		/**
+		 * @brief Number of actual points (excluding padding)
+		 */
+		size_t size() const { return m_count; }
+
+		/**
+		 * @brief Number of entries in each array, including padding. Always a multiple of Lanes::WIDTH
+		 */
+		size_t paddedSize() const { return posX.size(); }
+
+		bool empty() const { return m_count == 0; }
+
+		/**
+		 * @brief Resize the store. New points default to unit mass at the origin
+		 */
+		void resize(size_t count);
+
+		// positions
+		wf::Vec3 getPosition(size_t i) const { return { posX[i], posY[i], posZ[i] }; }
+		void setPosition(size_t i, const wf::Vec3& p) { posX[i] = p.x; posY[i] = p.y; posZ[i] = p.z; }
+		void movePosition(size_t i, const wf::Vec3& d) { posX[i] += d.x; posY[i] += d.y; posZ[i] += d.z; }
+
+		// velocities
+		wf::Vec3 getVelocity(size_t i) const { return { velX[i], velY[i], velZ[i] }; }
+		void setVelocity(size_t i, const wf::Vec3& v) { velX[i] = v.x; velY[i] = v.y; velZ[i] = v.z; }
+		void addVelocity(size_t i, const wf::Vec3& v) { velX[i] += v.x; velY[i] += v.y; velZ[i] += v.z; }
+
+		/**
+		 * @brief Set the velocity of all points in one go
+		 */
+		void setVelocities(const wf::Vec3& v);
+
+		// forces
+		wf::Vec3 getForce(size_t i) const { return { forceX[i], forceY[i], forceZ[i] }; }
+		void addForce(size_t i, const wf::Vec3& f) { forceX[i] += f.x; forceY[i] += f.y; forceZ[i] += f.z; }
+
+		/**
+		 * @brief Apply the same force to every point
+		 */
+		void addForces(const wf::Vec3& f);
+
+		/**
+		 * @brief Zero all accumulated forces
+		 */
+		void clearForces();
+
+		// mass
+		float getMass(size_t i) const { return mass[i]; }
+		float getInvMass(size_t i) const { return invMass[i]; }
+		void setMass(size_t i, float m) { mass[i] = m; invMass[i] = m > 0.f ? 1.f / m : 0.f; }
+
+		// last/global positions
+		wf::Vec3 getLastPosition(size_t i) const { return { lastX[i], lastY[i], lastZ[i] }; }
+		void setLastPosition(size_t i, const wf::Vec3& p) { lastX[i] = p.x; lastY[i] = p.y; lastZ[i] = p.z; }
+		wf::Vec3 getGlobalPosition(size_t i) const { return { globalX[i], globalY[i], globalZ[i] }; }
+		void setGlobalPosition(size_t i, const wf::Vec3& p) { globalX[i] = p.x; globalY[i] = p.y; globalZ[i] = p.z; }
+
+		// flags
+		bool isFixed(size_t i) const { return flags[i] & FIXED; }
+		void setFixed(size_t i, bool fixed = true) { setFlag(i, FIXED, fixed); }
+		bool isInsideAnother(size_t i) const { return flags[i] & INSIDE_ANOTHER; }
+		void setInsideAnother(size_t i, bool inside = true) { setFlag(i, INSIDE_ANOTHER, inside); }
+
+		/**
+		 * @brief Clear the inside-another flag on every point, ready for collision detection
+		 */
+		void clearInsideAnother();
+
+	private:
+		void setFlag(size_t i, uint8_t flag, bool on)
+		{
+			flags[i] = static_cast<uint8_t>(on ? (flags[i] | flag) : (flags[i] & ~flag));
+		}
+
+	private:
+		size_t m_count{ 0 };
+	};
+}
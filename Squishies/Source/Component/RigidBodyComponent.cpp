@@ -0,0 +1,16 @@
+#include "RigidBodyComponent.h"
+
+namespace Squishies::Component
+{
+	void RigidBody::build(const wf::Transform& transform)
+	{
+		// called every step for moving bodies, so this writes straight into the edges and the tree only refits
+		boundingBox = edges.setOutline(shape.points, transform, true);
+		edgeTree.refit(edges);
+	}
+
+	wf::Vec2 RigidBody::getVelocityAt(const wf::Vec2& point) const
+	{
+		return linearVelocity + wf::perpCCW(point - centre) * angularVelocity;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Engine.h"
+#include "Component/EdgeList.h"
+#include "Poly/Poly.h"
+#include "Utils/EdgeBVH.h"
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief A solid, unbending object simulated by Bullet through the RigidBodySystem, for props that don't need to squish.
+	 *
+	 * Bullet sees the convex hull of the shape, extruded through the plane. Soft bodies collide with the exact outline,
+	 * which is kept in world space here each step. Dynamic bodies drive the entity's transform; static and kinematic
+	 * ones follow it, so move a kinematic body by moving its transform. A Collider on the entity sets the Bullet
+	 * collision group and mask as well as which soft bodies it touches.
+	 */
+	struct RigidBody
+	{
+		enum class Type
+		{
+			STATIC,													// never moves
+			KINEMATIC,												// moved by the game, through the transform; pushes but can't be pushed
+			DYNAMIC,												// moved by the simulation
+		};
+
+		Poly shape;													// outline, relative to the transform
+		Type type{ Type::DYNAMIC };
+		float mass{ 1.f };											// ignored unless dynamic
+		float friction{ .5f };
+		float restitution{ .2f };
+		float depth{ 1.f };											// thickness through the plane, for Bullet
+
+		// kept up to date by the system
+		EdgeList edges;												// world space edges
+		EdgeBVH edgeTree;											// hierarchy over the edges
+		wf::BoundingBox boundingBox{};								// world space bounds
+		wf::Vec2 centre{};											// centre of mass, world space
+		wf::Vec2 linearVelocity{};
+		float angularVelocity{ 0.f };								// radians per second, anticlockwise
+		float invMass{ 0.f };										// 0 unless dynamic
+		float invInertia{ 0.f };									// about the axis through the plane
+
+		RigidBody(const Poly& shape, Type type = Type::DYNAMIC, float mass = 1.f) : shape(shape), type(type), mass(mass) {}
+
+		/**
+		 * @brief Rebuild the world space edges, tree and bounds from the shape and where it is now
+		 */
+		void build(const wf::Transform& transform);
+
+		/**
+		 * @brief Velocity of the body at a point in the world
+		 */
+		wf::Vec2 getVelocityAt(const wf::Vec2& point) const;
+	};
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "Engine.h"
-#include "Poly/Squishy.h"
+#include "Component/EdgeList.h"
+#include "Component/PointMasses.h"
+#include "Poly/ShapeAsset.h"
+#include "Utils/EdgeBVH.h"
 
 #include <bitset>
 
@@ -17,47 +20,6 @@
 
 namespace Squishies::Component
 {
-	struct PointMass
-	{
-		wf::Vec3 position{};										// point position
-		wf::Vec3 velocity{};										// current velocity for the point
-		wf::Vec3 force{};											// all forces (external & internal) applied
-		float mass{ 1.f };											// point mass
-		bool fixed{ false };										// fixed point; cannot move
-
-		wf::Vec3 lastPosition{};									// keeping tabs on last position for stability
-		wf::Vec3 globalPosition{};									// after transforming the original using derived vals
-
-		bool insideAnother{ false };								// collision detection picked up that this point is inside another object
-	};
-
-	struct Edge
-	{
-		wf::Vec3 dir{};
-		float length{};
-		wf::Vec3 p1{};
-		wf::Vec3 p2{};
-
-		Edge() = default;
-		Edge(wf::Vec3 p1, wf::Vec3 p2)
-		{
-			update(p1, p2);
-		}
-
-		void update(wf::Vec3 newP1, wf::Vec3 newP2)
-		{
-			p1 = newP1;
-			p2 = newP2;
-
-			wf::Vec3 e = p1 - p2; // @todo winding order
-			length = glm::length(e);
-			dir = glm::normalize(e);
-		}
-
-		bool operator==(const Edge& rhs) const { return p1 == rhs.p1 && p2 == rhs.p2 && dir == rhs.dir; }
-		bool operator!=(const Edge& rhs) const { return p1 != rhs.p1 || p2 != rhs.p2 || dir != rhs.dir; }
-	};
-
 	/**
 	 * @brief Main squishy body.
 	 *
@@ -65,13 +27,20 @@ namespace Squishies::Component
 	 */
 	struct SoftBody
 	{
-		Squishy shape;												// shape used to create the softbody along with joint data
-		std::vector<PointMass> points;								// all of our point masses
+		ShapeHandle shape;											// shared shape the softbody was created from, along with joint data
+		PointMasses points;											// all of our point masses (SoA)
 		wf::Colour colour{ wf::WHITE };								// general colour; not used at the mo for anything more than debugging. @todo
 
 		bool fixed{ false };										// if the body is entirely static.
 		bool kinematic{ false };
+		bool sleeping{ false };										// resting; left out of the simulation until woken
+		float sleepTimer{ 0.f };									// how long we've been quiet enough to sleep
+		uint32_t solverIndex{ 0 };									// our slot in the system's per-step body list
+		uint32_t lodSteps{ 0 };										// fixed steps since we were last simulated; more than 1 when at low detail
+		bool lodSkipped{ false };									// sitting this step out at low detail; held still like a sleeping body
+		bool fullDetail{ false };									// woken or pushed since the last step, so not left out of the next
 		bool shapeMatching{ true };									// whether shape matching is enabled
+		bool continuousCollision{ false };							// fast mover; sweep its points so it can't tunnel through thin bodies
 
 		float jointK{ 300.f };										// spring strength and damping for joints
 		float jointDamping{ 10.f };
@@ -84,14 +53,16 @@ namespace Squishies::Component
 
 		wf::Vec3 derivedPosition{};									// calculated position of the body as a whole
 		wf::Quat derivedRotation{};									// calcualted rotation of the body
+		wf::Vec2 derivedSpin{ 1.f, 0.f };							// the same rotation about Z, as (cos, sin)
 		wf::Vec3 derivedVelocity{};									// calculated velocity of the body
 
 		bool colliding{ false };									// whether we're colliding with another
 		wf::BoundingBox collisionBox{};								// bounding box containing all points currently colliding
 
-		wf::Bitfields bitFields;									// simple space partitioning, for collisons
+		wf::SpatialHashGrid::Handle gridProxy{ wf::SpatialHashGrid::INVALID };	// our registration in the system's spatial grid
 		wf::BoundingBox boundingBox{};								// cached bounding box from the mesh
-		std::vector<Edge> edges;									// edge data
+		EdgeList edges;												// edge data (SoA)
+		EdgeBVH edgeTree;											// hierarchy over the edges for collision queries
 
 		/**
 		 * @brief Update all metadata in one go
@@ -99,12 +70,14 @@ namespace Squishies::Component
 		void updateAll();
 
 		/**
-		 * @brief Updates the percieved position, rotation and velocity based on how the points have moved
+		 * @brief Updates the percieved position, rotation and velocity based on how the points have moved.
+		 *
+		 * The rotation is the one that best fits the rest shape onto the points, from their 2x2 covariance.
 		 */
 		void updateDerivedData();
 
 		/**
-		 * @brief Regenerate the bounding box data
+		 * @brief Regenerate the bounding box data. Covers the whole step's travel for continuous collision
 		 */
 		void updateBoundingBox();
 
@@ -113,11 +86,6 @@ namespace Squishies::Component
 		 */
 		void updateGlobalShape();
 
-		/**
-		 * @brief Update bitmask based on our position for collision filtering
-		 */
-		void updateBitfields();
-
 		/**
 		 * @brief Update all of the edge data in prep for collision detection
 		 */
@@ -130,7 +98,29 @@ namespace Squishies::Component
 		void setFixed(bool fixed = true);
 
 		/**
-		 * @brief Create softbody from a squishy instance
+		 * @brief Bring the body back into the simulation at full detail, and restart the quiet period before it can sleep
+		 * again. Call it whenever something pushes the body from outside
+		 */
+		void wake();
+
+		/**
+		 * @brief Take the body out of the simulation, bringing it to a stop
+		 */
+		void sleep();
+
+		/**
+		 * @brief Whether the simulation is moving this body at the moment
+		 */
+		bool isActive() const { return !fixed && !sleeping && !lodSkipped; }
+
+		/**
+		 * @brief Create softbody from a shared shape, in its default colour or another
+		 */
+		SoftBody(ShapeHandle shape);
+		SoftBody(ShapeHandle shape, const wf::Colour& colour);
+
+		/**
+		 * @brief Create softbody from a one-off squishy, building a shape just for it
 		 */
 		SoftBody(const Squishy& squishy);
 
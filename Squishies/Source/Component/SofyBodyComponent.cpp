@@ -5,6 +5,9 @@
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Squishies::Component
 {
 	void SoftBody::updateAll()
@@ -12,95 +15,85 @@ namespace Squishies::Component
 		updateDerivedData();
 		updateEdges();
 		updateBoundingBox();
-		updateBitfields();
 	}
 
 	void SoftBody::updateDerivedData()
 	{
-		// first figure out the center and velocity
-		const float invPCount = 1.f / this->points.size();
+		const size_t count = std::min(this->points.size(), this->shape->size());
+		if (count == 0) return;
+
+		const float* restX = this->shape->restX.data();
+		const float* restY = this->shape->restY.data();
+
+		// center, velocity and the covariance against the rest shape, in one pass. the rest shape is centred, so summing
+		// against the raw positions gives the same covariance as against positions relative to the center
 		wf::Vec3 center{};
 		wf::Vec3 velocity{};
+		float dotSum = 0.f;											// sum of rest . current
+		float crossSum = 0.f;										// sum of rest x current
 
-		for (size_t i = 0; i < this->points.size(); i++) {
-			center += this->points[i].position;
-			velocity += this->points[i].velocity;
+		for (size_t i = 0; i < count; i++) {
+			const float px = this->points.posX[i];
+			const float py = this->points.posY[i];
+
+			center += wf::Vec3{ px, py, this->points.posZ[i] };
+			velocity += this->points.getVelocity(i);
+
+			dotSum += restX[i] * px + restY[i] * py;
+			crossSum += restX[i] * py - restY[i] * px;
 		}
 
+		const float invPCount = 1.f / count;
 		this->derivedPosition = center * invPCount;
 		this->derivedVelocity = velocity * invPCount;
 
-		// now find the average angle
-		// Original and current average normals
-		// Project all positions to X/Y plane and calculate average angle offset
-		float angleSum = 0.f;
-
-		for (size_t i = 0; i < this->points.size(); i++) {
-			glm::vec2 base2 = glm::vec2(this->shape.getPoint(i));
-			glm::vec2 curr2 = glm::vec2(this->points[i].position - this->derivedPosition);
+		// the polar decomposition of a 2x2 covariance is a rotation by atan2(cross, dot); we only need its cos and sin.
+		// collapsed to a point there's no rotation to find, so keep the last one
+		const float len = std::sqrt(dotSum * dotSum + crossSum * crossSum);
+		if (len < 1e-6f) return;
 
-			float baseAngle = atan2(base2.y, base2.x);
-			float currAngle = atan2(curr2.y, curr2.x);
+		this->derivedSpin = { dotSum / len, crossSum / len };
 
-			float delta = currAngle - baseAngle;
-			if (delta > glm::pi<float>()) delta -= glm::two_pi<float>();
-			if (delta < -glm::pi<float>()) delta += glm::two_pi<float>();
-			angleSum += delta;
-		}
-
-		float avgAngle = angleSum / this->points.size();
-		this->derivedRotation = glm::angleAxis(avgAngle, glm::vec3(0, 0, 1));
+		// and the quaternion about Z from the half angle
+		const float c = this->derivedSpin.x;
+		const float halfCos = std::sqrt(std::max(0.f, (1.f + c) * .5f));
+		const float halfSin = std::copysign(std::sqrt(std::max(0.f, (1.f - c) * .5f)), this->derivedSpin.y);
+		this->derivedRotation = wf::Quat(halfCos, 0.f, 0.f, halfSin);
 	}
 
 	void SoftBody::updateBoundingBox()
 	{
 		boundingBox.reset();
 
-		for (auto& v : this->points) {
-			boundingBox.extend(v.position);
-			boundingBox.extend(v.position + wf::Vec3{ 0.f, 0.f, .1f }); // @todo may revisit, but we're nudging a little bit for the z
+		for (size_t i = 0; i < this->points.size(); i++) {
+			wf::Vec3 pos = this->points.getPosition(i);
+			boundingBox.extend(pos);
+			boundingBox.extend(pos + wf::Vec3{ 0.f, 0.f, BOUNDS_DEPTH }); // @todo may revisit, but we're nudging a little bit for the z
 		}
-	}
 
-	void SoftBody::updateGlobalShape()
-	{
-		for (size_t i = 0; i < this->points.size(); i++) {
-			this->points[i].globalPosition = wf::Vec3(this->shape.getPoint(i), 0.f) + this->derivedPosition;
-			// @todo apply rotation
+		// so the broadphase pairs us with anything we might have passed through on the way
+		if (this->continuousCollision) {
+			for (size_t i = 0; i < this->points.size(); i++) {
+				boundingBox.extend(this->points.getLastPosition(i));
+			}
 		}
 	}
 
-	void SoftBody::updateBitfields()
+	void SoftBody::updateGlobalShape()
 	{
-		auto worldBounds = Config::get().worldBounds;
-		auto gridCellSize = Config::get().spatialGridSize;
-
-		wf::Vec3 gridStep = worldBounds.size() / gridCellSize;
+		const size_t count = std::min(this->points.size(), this->shape->size());
 
-		int minX = (int)floor((boundingBox.min.x - worldBounds.min.x) / gridStep.x);
-		int maxX = (int)floor((boundingBox.max.x - worldBounds.min.x) / gridStep.x);
-		int minY = (int)floor((boundingBox.min.y - worldBounds.min.y) / gridStep.y);
-		int maxY = (int)floor((boundingBox.max.y - worldBounds.min.y) / gridStep.y);
-		int minZ = (int)floor((boundingBox.min.z - worldBounds.min.z) / gridStep.z);
-		int maxZ = (int)floor((boundingBox.max.z - worldBounds.min.z) / gridStep.z);
+		const float* restX = this->shape->restX.data();
+		const float* restY = this->shape->restY.data();
 
-		minX = glm::clamp(minX, 0, static_cast<int>(gridCellSize));
-		minY = glm::clamp(minY, 0, static_cast<int>(gridCellSize));
-		minZ = glm::clamp(minZ, 0, static_cast<int>(gridCellSize));
-		maxX = glm::clamp(maxX, 0, static_cast<int>(gridCellSize));
-		maxY = glm::clamp(maxY, 0, static_cast<int>(gridCellSize));
-		maxZ = glm::clamp(maxZ, 0, static_cast<int>(gridCellSize));
+		const float c = this->derivedSpin.x;
+		const float s = this->derivedSpin.y;
+		const wf::Vec3 center = this->derivedPosition;
 
-		this->bitFields.clear();
-
-		for (int i = minX; i <= maxX; i++) {
-			this->bitFields.x.setOn(i);
-		}
-		for (int i = minY; i <= maxY; i++) {
-			this->bitFields.y.setOn(i);
-		}
-		for (int i = minZ; i <= maxZ; i++) {
-			this->bitFields.z.setOn(i);
+		for (size_t i = 0; i < count; i++) {
+			this->points.globalX[i] = center.x + c * restX[i] - s * restY[i];
+			this->points.globalY[i] = center.y + s * restX[i] + c * restY[i];
+			this->points.globalZ[i] = center.z;
 		}
 	}
 
@@ -113,13 +106,15 @@ namespace Squishies::Component
 		for (size_t i = 0; i < this->points.size(); i++) {
 			size_t j = (i + 1) % this->points.size();
 
-			this->edges[i].update(this->points[i].position, this->points[j].position);
+			this->edges.set(i, { this->points.posX[i], this->points.posY[i] }, { this->points.posX[j], this->points.posY[j] });
 
 			// debug the edges
-			/*wf::Vec3 center = (this->edges[i].p1 + this->edges[i].p2) * 0.5f;
-			wf::Vec3 normal = glm::normalize(wf::Vec3{ -this->edges[i].dir.y, this->edges[i].dir.x, 0.f });
+			/*wf::Vec3 center = wf::Vec3((this->edges.getP1(i) + this->edges.getP2(i)) * 0.5f, 0.f);
+			wf::Vec3 normal = wf::Vec3(this->edges.getNormal(i), 0.f);
 			wf::Debug::line(center, center + normal * .2f, 2.f, wf::WHITE);*/
 		}
+
+		this->edgeTree.refit(this->edges);
 	}
 
 	void SoftBody::setFixed(bool fixed)
@@ -127,7 +122,32 @@ namespace Squishies::Component
 		this->fixed = fixed;
 	}
 
-	SoftBody::SoftBody(const Squishy& squishy) : shape(squishy), colour(squishy.colour)
+	void SoftBody::wake()
+	{
+		this->sleeping = false;
+		this->sleepTimer = 0.f;
+		this->fullDetail = true;
+	}
+
+	void SoftBody::sleep()
+	{
+		this->sleeping = true;
+		this->lodSteps = 0;
+		this->lodSkipped = false;
+		this->derivedVelocity = {};
+		this->points.setVelocities({});
+		this->points.clearForces();
+	}
+
+	SoftBody::SoftBody(ShapeHandle shape) : shape(shape), colour(shape->squishy.colour)
+	{
+	}
+
+	SoftBody::SoftBody(ShapeHandle shape, const wf::Colour& colour) : shape(shape), colour(colour)
+	{
+	}
+
+	SoftBody::SoftBody(const Squishy& squishy) : SoftBody(ShapeAsset::create(squishy))
 	{
 	}
 }
\ No newline at end of file
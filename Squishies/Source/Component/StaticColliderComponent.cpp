@@ -0,0 +1,10 @@
+#include "StaticColliderComponent.h"
+
+namespace Squishies::Component
+{
+	void StaticCollider::build(const wf::Transform& transform)
+	{
+		boundingBox = edges.setOutline(shape.points, transform, closed);
+		edgeTree.build(edges);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Engine.h"
+#include "Component/EdgeList.h"
+#include "Poly/Poly.h"
+#include "Utils/EdgeBVH.h"
+
+namespace Squishies::Component
+{
+	/**
+	 * @brief Immovable level geometry that soft bodies collide against.
+	 *
+	 * Either a closed polygon, solid inside, or an open polyline that's solid on one side: the left of the direction the
+	 * points run in, the same as the inside of an anticlockwise polygon. The shape is placed in the world by the entity's
+	 * transform once, when it's built, and never changes after; there are no point masses and nothing to update per step.
+	 */
+	struct StaticCollider
+	{
+		Poly shape;													// outline, relative to the transform
+		bool closed{ true };										// polygon (true) or one-sided polyline (false)
+
+		EdgeList edges;												// world space edges, built once
+		EdgeBVH edgeTree;											// hierarchy over the edges
+		wf::BoundingBox boundingBox{};								// world space bounds
+		wf::SpatialHashGrid::Handle gridProxy{ wf::SpatialHashGrid::INVALID };	// our registration in the system's static grid
+
+		StaticCollider(const Poly& shape, bool closed = true) : shape(shape), closed(closed) {}
+
+		/**
+		 * @brief Build the world space edges, tree and bounds from the shape and where it's been placed
+		 */
+		void build(const wf::Transform& transform);
+	};
+}
@@ -11,7 +11,17 @@ namespace Squishies
 		worldBounds.extend({ -50.f, -10.f, -1.f });
 		worldBounds.extend({ 50.f, 50.f, 1.f });
 
-		spatialGridSize = 32.f;
+		spatialCellSize = 4.f;
+		physicsThreads = 0;
+		simulationThread = false;
+
+		sleeping = true;
+		sleepEnergy = .01f;
+		sleepDelay = 1.f;
+
+		lod = true;
+		lodDistance = 60.f;
+		lodInterval = 4;
 	}
 
 	Config& Config::get()
@@ -7,7 +7,17 @@ namespace Squishies
 	{
 		float gravity{};
 		wf::BoundingBox worldBounds{};
-		float spatialGridSize{};
+		float spatialCellSize{};									// cell size for the spatial hash grid
+		size_t physicsThreads{};									// threads for the physics; 0 for one per hardware thread
+		bool simulationThread{};									// step the soft bodies on their own thread, alongside the render; not with liquid or rigid bodies
+
+		bool sleeping{};											// let resting bodies drop out of the simulation
+		float sleepEnergy{};										// kinetic energy per unit mass below which a body is resting
+		float sleepDelay{};											// seconds a body has to be resting before it sleeps
+
+		bool lod{};													// step off-screen and distant bodies less often (XPBD only)
+		float lodDistance{};										// distance from the camera beyond which a body is distant
+		uint32_t lodInterval{};										// fixed steps between updates for off-screen/distant bodies
 
 		Config();
 		static Config& get();
@@ -0,0 +1,34 @@
+#include "ShapeAsset.h"
+
+namespace Squishies
+{
+	ShapeHandle ShapeAsset::create(const Squishy& squishy)
+	{
+		auto asset = std::make_shared<ShapeAsset>();
+		asset->squishy = squishy;
+
+		const auto& points = squishy.getPoints();
+
+		asset->joints.build(squishy.getJoints(), points.size());
+
+		// rest shape about its centre, which is all the shape matching needs of it
+		if (!points.empty()) {
+			for (const auto& pt : points) {
+				asset->restCenter += pt;
+			}
+			asset->restCenter /= static_cast<float>(points.size());
+		}
+
+		asset->restX.resize(points.size());
+		asset->restY.resize(points.size());
+
+		for (size_t i = 0; i < points.size(); i++) {
+			asset->restX[i] = points[i].x - asset->restCenter.x;
+			asset->restY[i] = points[i].y - asset->restCenter.y;
+		}
+
+		asset->mesh = asset->squishy.createMesh();
+
+		return asset;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Engine.h"
+
+#include "Component/JointList.h"
+#include "Squishy.h"
+
+#include <memory>
+#include <vector>
+
+namespace Squishies
+{
+	struct ShapeAsset;
+
+	/**
+	 * @brief Shared, read-only reference to a shape asset. Bodies hold one of these rather than their own copy
+	 */
+	using ShapeHandle = std::shared_ptr<const ShapeAsset>;
+
+	/**
+	 * @brief Everything about a soft body's shape that doesn't change once it's built, shared by every body made from it.
+	 *
+	 * Build one per prototype and hand the handle to each SoftBody; the asset lives for as long as something refers to it.
+	 */
+	struct ShapeAsset
+	{
+		Squishy squishy;											// rest positions, joints and default colour
+		Component::JointList joints;								// the joints, packed for the solvers
+		std::vector<float> restX, restY;							// rest shape about its own centre, for shape matching
+		wf::Vec2 restCenter{};										// where that centre is in shape space
+		std::shared_ptr<const wf::Mesh> mesh;						// template render mesh; never drawn itself, the batches copy from it
+
+		size_t size() const { return restX.size(); }
+
+		/**
+		 * @brief Build an asset from a squishy
+		 */
+		static ShapeHandle create(const Squishy& squishy);
+	};
+}
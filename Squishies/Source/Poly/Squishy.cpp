@@ -2,12 +2,12 @@
 
 namespace Squishies
 {
-	const std::vector<wf::Vec2> Squishy::getPoints() const
+	const std::vector<wf::Vec2>& Squishy::getPoints() const
 	{
 		return poly.points;
 	}
 
-	const std::vector<Joint> Squishy::getJoints() const
+	const std::vector<Joint>& Squishy::getJoints() const
 	{
 		return joints;
 	}
@@ -26,8 +26,8 @@ namespace Squishies
 		Squishy(const Poly& poly) : poly(poly) {}
 		Squishy(const Poly& poly, std::vector<Joint> joints) : poly(poly), joints(joints) {}
 
-		const std::vector<wf::Vec2> getPoints() const;
-		const std::vector<Joint> getJoints() const;
+		const std::vector<wf::Vec2>& getPoints() const;
+		const std::vector<Joint>& getJoints() const;
 
 		const wf::Vec2 getPoint(size_t index) const;
 
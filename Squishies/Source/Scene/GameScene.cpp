@@ -4,13 +4,19 @@
 #include "Component/CharacterComponent.h"
 #include "Component/ColliderComponent.h"
 #include "Component/InventoryComponent.h"
+#include "Component/LiquidComponent.h"
+#include "Component/RigidBodyComponent.h"
 #include "Component/SoftBodyComponent.h"
+#include "Component/StaticColliderComponent.h"
 #include "Component/UserControlComponent.h"
 #include "Poly/PolyFactory.h"
 #include "Poly/SquishyFactory.h"
+#include "System/SoftBodyRenderSystem.h"
 #include "System/SoftBodySystem.h"
 #include "System/CharacterDamageSystem.h"
+#include "System/LiquidSystem.h"
 #include "System/MovementSystem.h"
+#include "System/RigidBodySystem.h"
 #include "System/WeaponSystem.h"
 
 #include <imgui.h>
@@ -22,10 +28,15 @@ namespace Squishies
 	{
 		addSystem<wf::system::RenderSystem>();
 		addSystem<wf::system::CameraSystem>();
-		addSystem<SoftBodySystem>();
+		auto& physics = addSystem<SoftBodySystem>();
+		physics.setIntegrator(SoftBodySystem::Integrator::XPBD, 8, true);
+		m_physics = &physics;
+		addSystem<LiquidSystem>(&physics);
+		addSystem<RigidBodySystem>(&physics);
 		addSystem<MovementSystem>();
-		addSystem<WeaponSystem>();
+		addSystem<WeaponSystem>(&physics);
 		addSystem<CharacterDamageSystem>();
+		addSystem<SoftBodyRenderSystem>(&physics);
 
 		return wf::Scene::init();
 	}
@@ -61,6 +72,7 @@ namespace Squishies
 		auto woodNorm = wf::loadTexture("resources/images/wood_planks_12_normal_gl_1k.png");
 
 		// squishies
+		m_squishyMaterial = wf::createPhongMaterial();
 		createSquishy("Squishy 1", { -2.f, -5.f, 0.f }, wf::RED)
 			.addComponent<Component::UserControl>();
 		createSquishy("Squishy 2", { -1.2f, -3.f, 0.f }, wf::BLUE);
@@ -74,9 +86,7 @@ namespace Squishies
 			meshRenderer.material = wf::createPhongMaterial();
 			meshRenderer.material.diffuse.map = woodTex;
 			meshRenderer.material.normal.map = woodNorm;
-			auto& beam = obj.addComponent<Component::SoftBody>(SquishyFactory::createRect(100.f, 10.f));
-			beam.setFixed();
-			obj.addComponent<Component::Collider>(CollisionGroup::STATIC, CollisionGroup::ALL & ~(CollisionGroup::STATIC));
+			obj.addComponent<Component::StaticCollider>(SquishyFactory::createRect(100.f, 10.f).poly);
 		}
 
 		// and a platform
@@ -90,8 +100,7 @@ namespace Squishies
 			meshRenderer.material = wf::createPhongMaterial();
 			meshRenderer.material.diffuse.map = woodTex;
 			meshRenderer.material.normal.map = woodNorm;
-			obj.addComponent<Component::SoftBody>(platformSquishy).setFixed();
-			obj.addComponent<Component::Collider>(CollisionGroup::STATIC, CollisionGroup::ALL & ~(CollisionGroup::STATIC));
+			obj.addComponent<Component::StaticCollider>(platformSquishy.poly);
 		}
 
 		{
@@ -100,13 +109,44 @@ namespace Squishies
 			auto& meshRenderer = obj.addComponent<wf::MeshRendererComponent>();
 			meshRenderer.material = wf::createPhongMaterial();
 			//meshRenderer.material.specular.intensity = 1.5f;
-			obj.addComponent<Component::SoftBody>(SquishyFactory::createGear(1.5, 10, .3f, wf::BLACK)).setFixed();
+			meshRenderer.material.diffuse.colour = wf::BLACK;
 			obj.addComponent<Component::Collider>(CollisionGroup::KINEMATIC);
+			obj.addComponent<Component::RigidBody>(SquishyFactory::createGear(1.5, 10, .3f).poly, Component::RigidBody::Type::KINEMATIC);
+		}
+
+		// something solid to knock about
+		{
+			auto obj = createObject({ 2.f, 2.f, 0.f });
+			obj.addComponent<wf::NameTagComponent>("Crate");
+			auto& meshRenderer = obj.addComponent<wf::MeshRendererComponent>();
+			meshRenderer.material = wf::createPhongMaterial();
+			meshRenderer.material.diffuse.map = woodTex;
+			meshRenderer.material.normal.map = woodNorm;
+			obj.addComponent<Component::RigidBody>(PolyFactory::createSquare(1.5f), Component::RigidBody::Type::DYNAMIC, 5.f);
+		}
+
+		// a pool of water off to the side
+		{
+			auto obj = createObject();
+			obj.addComponent<wf::NameTagComponent>("Water");
+			obj.addComponent<wf::MeshRendererComponent>().material = wf::createBasicMaterial();
+			obj.addComponent<Component::Collider>(CollisionGroup::LIQUID);
+			obj.addComponent<Component::Liquid>().fillRect({ 8.f, -10.f }, { 14.f, -6.f });
 		}
 
 		wf::Scene::setup();
 	}
 
+	void GameScene::launchBackgroundWork()
+	{
+		m_physics->launchSimulation();
+	}
+
+	void GameScene::syncBackgroundWork()
+	{
+		m_physics->syncSimulation();
+	}
+
 	void GameScene::renderGui(float dt)
 	{
 		auto& camera = *getCurrentCamera();
@@ -116,8 +156,9 @@ namespace Squishies
 		{
 			ImGui::Checkbox("Debug", &m_debug);
 
+			// the bodies may be stepping on the simulation thread while we're drawing this, so changes to them wait for it
 			if (ImGui::Button("Reset")) {
-				resetSquishies();
+				m_physics->post([this] { resetSquishies(); });
 			}
 
 			ImGui::Separator();
@@ -147,6 +188,43 @@ namespace Squishies
 			}
 			ImGui::PopID();
 
+			ImGui::PushID("Physics");
+			{
+				ImGui::SeparatorText("Physics");
+
+				bool xpbd = m_physics->getIntegrator() == SoftBodySystem::Integrator::XPBD;
+				bool adaptive = m_physics->isAdaptive();
+				int substeps = static_cast<int>(m_physics->getSubsteps());
+
+				bool changed = ImGui::Checkbox("XPBD", &xpbd);
+				if (xpbd) {
+					changed |= ImGui::Checkbox("Adaptive substeps", &adaptive);
+					changed |= ImGui::SliderInt(adaptive ? "Max substeps" : "Substeps", &substeps, 1, 32);
+				}
+
+				if (changed) {
+					m_physics->post([this, xpbd, substeps, adaptive] {
+						m_physics->setIntegrator(xpbd ? SoftBodySystem::Integrator::XPBD : SoftBodySystem::Integrator::FORCES, static_cast<uint32_t>(substeps), adaptive);
+						});
+				}
+
+				// the liquid and the rigid bodies push on the soft bodies every step, so they can't be stepped apart
+				bool threaded = m_physics->isSimulationThreaded();
+				ImGui::BeginDisabled(m_physics->hasCoupledSystems());
+				if (ImGui::Checkbox("Simulation thread", &threaded)) {
+					m_physics->post([this, threaded] { m_physics->setSimulationThread(threaded); });
+				}
+				ImGui::EndDisabled();
+
+				auto policy = wf::getFixedStepPolicy();
+				int maxSteps = static_cast<int>(policy.maxStepsPerFrame);
+				if (ImGui::SliderInt("Max steps/frame", &maxSteps, 0, 20)) {
+					policy.maxStepsPerFrame = static_cast<uint32_t>(maxSteps);
+					wf::setFixedStepPolicy(policy);
+				}
+			}
+			ImGui::PopID();
+
 			// INVENTORIES
 			getEntityManager()->each<wf::NameTagComponent, Component::Inventory>(
 				[&](wf::EntityID id, const wf::NameTagComponent& nametag, Component::Inventory& inventory) {
@@ -181,17 +259,44 @@ namespace Squishies
 						ImGui::SliderFloat("Spec. shine", &meshRenderer.material.specular.shininess, 0.f, 128.f);
 
 						if (ent.hasComponent<Component::SoftBody>()) {
-							auto& squishy = ent.getComponent<Component::SoftBody>();
+							const auto& squishy = ent.getComponent<Component::SoftBody>();
+
+							// the settings are only ever changed from here, so reading them is safe; writes are posted
+							bool shapeMatching = squishy.shapeMatching;
+							float shapeK = squishy.shapeMatchK;
+							float shapeD = squishy.shapeMatchDamping;
+							float jointK = squishy.jointK;
+							float jointD = squishy.jointDamping;
+
+							bool changed = ImGui::Checkbox("Shape matching", &shapeMatching);
+							if (shapeMatching) {
+								changed |= ImGui::SliderFloat("ShapeK", &shapeK, 1.f, 5000.f);
+								changed |= ImGui::SliderFloat("ShapeD", &shapeD, 1.f, 150.f);
+							}
+							changed |= ImGui::SliderFloat("JointK", &jointK, 1.f, 5000.f);
+							changed |= ImGui::SliderFloat("JointD", &jointD, 1.f, 150.f);
+
+							if (changed) {
+								m_physics->post([ent, shapeMatching, shapeK, shapeD, jointK, jointD]() mutable {
+									auto& softbody = ent.getComponent<Component::SoftBody>();
+									softbody.shapeMatching = shapeMatching;
+									softbody.shapeMatchK = shapeK;
+									softbody.shapeMatchDamping = shapeD;
+									softbody.jointK = jointK;
+									softbody.jointDamping = jointD;
+									});
+							}
 
-							ImGui::Checkbox("Shape matching", &squishy.shapeMatching);
-							if (squishy.shapeMatching) {
-								ImGui::SliderFloat("ShapeK", &squishy.shapeMatchK, 1.f, 5000.f);
-								ImGui::SliderFloat("ShapeD", &squishy.shapeMatchDamping, 1.f, 150.f);
+							// the rest comes from the latest snapshot, if the simulation's on its own thread
+							const wf::Vec3* derivedPosition = &squishy.derivedPosition;
+							if (m_physics->isSimulationThreaded()) {
+								auto* state = m_physics->getSnapshot().find(id);
+								derivedPosition = state ? &state->derivedPosition : nullptr;
 							}
-							ImGui::SliderFloat("JointK", &squishy.jointK, 1.f, 5000.f);
-							ImGui::SliderFloat("JointD", &squishy.jointDamping, 1.f, 150.f);
 
-							ImGui::Text("Derived pos: %.2f %.2f %.2f", squishy.derivedPosition.x, squishy.derivedPosition.y, squishy.derivedPosition.z);
+							if (derivedPosition) {
+								ImGui::Text("Derived pos: %.2f %.2f %.2f", derivedPosition->x, derivedPosition->y, derivedPosition->z);
+							}
 
 							// wf::Debug::filledCircle(squishy.derivedPosition, 5.f, wf::YELLOW); // derived position
 							// wf::Debug::rect(squishy.boundingBox, 2.f, wf::WHITE); // bounding box
@@ -214,9 +319,13 @@ namespace Squishies
 		getEntityManager()->each<wf::TransformComponent, Component::SoftBody>(
 			[&](wf::EntityID id, wf::TransformComponent& transform, Component::SoftBody& softbody) {
 				for (size_t i = 0; i < softbody.points.size(); i++) {
-					softbody.points[i].position = wf::Vec3(softbody.shape.poly.points[i], 0.f) + softbody.originalPosition;
-					softbody.points[i].velocity = softbody.points[i].force = {};
+					wf::Vec3 pos = wf::Vec3(softbody.shape->squishy.getPoint(i), 0.f) + softbody.originalPosition;
+					softbody.points.setPosition(i, pos);
+					softbody.points.setLastPosition(i, pos);
+					softbody.points.setVelocity(i, {});
 				}
+				softbody.points.clearForces();
+				softbody.wake();
 
 				softbody.updateDerivedData();
 				softbody.updateEdges();
@@ -226,28 +335,26 @@ namespace Squishies
 
 	wf::Entity GameScene::createSquishy(const std::string& name, const wf::Vec3 pos, const wf::Colour& colour)
 	{
-		static Squishy _proto = SquishyFactory::createCircle(
+		static ShapeHandle proto = ShapeAsset::create(SquishyFactory::createCircle(
 			1.f,		// radius
 			20,			// number of points on the squishies
 			3			// how much support with joints etc.
-		);
-
-		Squishy proto = _proto;
-		proto.colour = colour;
+		));
 
 		// main object
 		auto obj = createObject(pos);
 		obj.addComponent<wf::NameTagComponent>(name);
 		obj.addComponent<Component::Character>();
+
 		auto& meshRenderer = obj.addComponent<wf::MeshRendererComponent>();
-		meshRenderer.material = wf::createPhongMaterial();
+		meshRenderer.material = m_squishyMaterial;
 		//meshRenderer.material.specular.intensity = 1.5f;
 
 		// collider
 		obj.addComponent<Component::Collider>(CollisionGroup::CHARACTER);
 
 		// main softbody instance
-		obj.addComponent<Component::SoftBody>(proto);
+		obj.addComponent<Component::SoftBody>(proto, colour);
 
 		// inventory for weapons
 		resetInventory(obj);
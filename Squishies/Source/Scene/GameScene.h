@@ -3,6 +3,8 @@
 
 namespace Squishies
 {
+	class SoftBodySystem;
+
 	class GameScene : public wf::Scene
 	{
 	public:
@@ -13,6 +15,10 @@ namespace Squishies
 		virtual void setup() override;
 		virtual void renderGui(float dt) override;
 
+		// with a simulation thread, the soft body steps recorded in fixedUpdate run alongside the render
+		virtual void launchBackgroundWork() override;
+		virtual void syncBackgroundWork() override;
+
 	private:
 		void resetSquishies();
 		wf::Entity createSquishy(const std::string& name, const wf::Vec3 pos, const wf::Colour& colour);
@@ -20,5 +26,7 @@ namespace Squishies
 
 	private:
 		bool m_debug{ true };
+		SoftBodySystem* m_physics{ nullptr };
+		wf::Material m_squishyMaterial;								// one shader between the squishies, so they can be drawn together
 	};
 }
\ No newline at end of file
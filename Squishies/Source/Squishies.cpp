@@ -41,6 +41,9 @@ namespace Squishies
 
 			m_scene->update(wf::getDeltaTime());
 
+			// anything the scene can get on with alongside the render and the swap
+			m_scene->launchBackgroundWork();
+
 			if (wf::beginDrawing()) {
 				m_scene->render(wf::getDeltaTime());
 
@@ -51,6 +54,9 @@ namespace Squishies
 
 				wf::endDrawing();
 			}
+
+			// and have finished before the next frame's game logic
+			m_scene->syncBackgroundWork();
 		}
 
 		SDL_DestroyCursor(cursor);
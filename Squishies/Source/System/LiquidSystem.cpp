@@ -0,0 +1,490 @@
+#include "LiquidSystem.h"
+
+#include "Component/ColliderComponent.h"
+#include "Component/HeightfieldColliderComponent.h"
+#include "Component/SoftBodyComponent.h"
+#include "Component/StaticColliderComponent.h"
+#include "Config.h"
+#include "System/SoftBodySystem.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace Squishies
+{
+	namespace
+	{
+		constexpr float TENSILE_K = .1f;							// strength of the artificial pressure that stops particles clumping
+		constexpr float TENSILE_Q = .2f;							// its reference distance, as a fraction of the kernel radius
+	}
+
+	LiquidSystem::LiquidSystem(wf::Scene* scene, SoftBodySystem* physics)
+		:ISystem(scene), m_physics(physics), m_collider(scene->getEventDispatcher())
+	{
+		// we push on the soft bodies every step, so they have to be stepped alongside us
+		m_physics->addCoupledSystem();
+	}
+
+	bool LiquidSystem::init()
+	{
+		return true;
+	}
+
+	void LiquidSystem::update(float dt)
+	{
+		entityManager->each<Component::Liquid, wf::MeshRendererComponent>(
+			[&](Component::Liquid& liquid, wf::MeshRendererComponent& meshRenderer) {
+				updateMesh(liquid, meshRenderer);
+			});
+	}
+
+	// a step, foreach liquid:
+	//		1. PREDICT: apply gravity and move each particle to where it would go unhindered
+	//		2. GRID: bin the predictions into cells and sort the particles by cell
+	//		3. DENSITY: push particles apart (or together) until each has about the density of the liquid at rest
+	//		4. COLLISIONS: push particles out of soft bodies (pushing back on them) and then the level
+	//		5. FINISH: velocities from how far the particles actually went, smoothed with their neighbours'
+	void LiquidSystem::fixedUpdate(float dt)
+	{
+		// the soft bodies are done with their pool by now
+		m_threadPool = &m_physics->getThreadPool();
+
+		entityManager->each<Component::Liquid>(
+			[&](wf::EntityID id, Component::Liquid& liquid) {
+				if (!liquid.size()) return;
+
+				int collisionGroup = CollisionGroup::LIQUID;
+				int collisionMask = CollisionGroup::ALL;
+
+				auto entity = entityManager->get(id);
+				if (entity.hasComponent<Component::Collider>()) {
+					const auto& collider = entity.getComponent<Component::Collider>();
+					collisionGroup = collider.collisionGroup;
+					collisionMask = collider.collisionMask;
+				}
+
+				simulate(liquid, collisionGroup, collisionMask, dt);
+			});
+	}
+
+	void LiquidSystem::simulate(Component::Liquid& liquid, int collisionGroup, int collisionMask, float dt)
+	{
+		// 2D kernels: poly6 for density, spiky for the pressure gradient
+		m_h = liquid.getKernelRadius();
+		m_invH = 1.f / m_h;
+		m_poly6 = 4.f / (PI * std::pow(m_h, 8.f));
+		m_spiky = -30.f / (PI * std::pow(m_h, 5.f));
+
+		const float h2 = m_h * m_h;
+		auto poly6 = [&](float r2) { float d = h2 - r2; return m_poly6 * d * d * d; };
+
+		// what a particle sees at rest, from a perfect lattice at rest spacing. normalising by this rather than a mass and
+		// rest density means the solve doesn't care what units anything's in
+		const float spacing = liquid.getSpacing();
+		const int reach = static_cast<int>(std::ceil(m_h / spacing));
+
+		float restSum = 0.f;
+		float restGrad2 = 0.f;
+		for (int y = -reach; y <= reach; y++) {
+			for (int x = -reach; x <= reach; x++) {
+				float r2 = (x * x + y * y) * spacing * spacing;
+				if (r2 >= h2) continue;
+
+				restSum += poly6(r2);
+				if (r2 > 0.f) {
+					float r = std::sqrt(r2);
+					float g = m_spiky * (m_h - r) * (m_h - r);
+					restGrad2 += g * g;
+				}
+			}
+		}
+
+		m_invRest = 1.f / restSum;
+		m_epsilon = liquid.relaxation * restGrad2 * m_invRest * m_invRest;
+		m_corrW = poly6(TENSILE_Q * TENSILE_Q * h2);
+
+		const size_t count = liquid.size();
+		m_predX.resize(count);
+		m_predY.resize(count);
+		m_lambda.resize(count);
+		m_deltaX.resize(count);
+		m_deltaY.resize(count);
+
+		predict(liquid, dt);
+		buildGrid(liquid);
+		solveDensity(liquid);
+		collide(liquid, collisionGroup, collisionMask, dt);
+		finish(liquid, dt);
+	}
+
+	// 1. PREDICT
+	void LiquidSystem::predict(Component::Liquid& liquid, float dt)
+	{
+		const float gravity = Config::get().gravity;
+
+		m_threadPool->parallelFor(liquid.size(),
+			[&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					liquid.velY[i] += gravity * dt;
+					m_predX[i] = liquid.posX[i] + liquid.velX[i] * dt;
+					m_predY[i] = liquid.posY[i] + liquid.velY[i] * dt;
+				}
+			}, PARTICLE_GRAIN);
+	}
+
+	// 2. GRID: hash each prediction's cell, counting sort by it, then reorder everything the same way. a stable sort, so
+	// the result only depends on where the particles are
+	void LiquidSystem::buildGrid(Component::Liquid& liquid)
+	{
+		const size_t count = liquid.size();
+
+		uint32_t tableSize = 64;
+		while (tableSize < count * 2) tableSize <<= 1;
+		m_gridMask = tableSize - 1;
+
+		m_keys.resize(count);
+		m_cellStart.assign(tableSize + 1, 0);
+		liquid.boundingBox.reset();
+
+		for (size_t i = 0; i < count; i++) {
+			int cx = static_cast<int>(std::floor(m_predX[i] * m_invH));
+			int cy = static_cast<int>(std::floor(m_predY[i] * m_invH));
+			m_keys[i] = cellKey(cx, cy);
+			m_cellStart[m_keys[i] + 1]++;
+
+			liquid.boundingBox.extend({ m_predX[i], m_predY[i], 0.f });
+		}
+
+		liquid.boundingBox.extend({ liquid.boundingBox.max.x, liquid.boundingBox.max.y, Component::BOUNDS_DEPTH });
+
+		for (uint32_t k = 0; k < tableSize; k++) {
+			m_cellStart[k + 1] += m_cellStart[k];
+		}
+
+		// placing each one moves its cell's start along to the next free slot; shift them back afterwards
+		m_order.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			m_order[m_cellStart[m_keys[i]]++] = static_cast<uint32_t>(i);
+		}
+		for (uint32_t k = tableSize; k > 0; k--) {
+			m_cellStart[k] = m_cellStart[k - 1];
+		}
+		m_cellStart[0] = 0;
+
+		m_scratch.resize(count);
+		auto reorder = [&](std::vector<float>& values) {
+			for (size_t j = 0; j < count; j++) {
+				m_scratch[j] = values[m_order[j]];
+			}
+			values.swap(m_scratch);
+		};
+
+		reorder(liquid.posX);
+		reorder(liquid.posY);
+		reorder(liquid.velX);
+		reorder(liquid.velY);
+		reorder(m_predX);
+		reorder(m_predY);
+	}
+
+	// 3. DENSITY: foreach iteration
+	//		1. lambda for each particle: how far its density is over rest, against how much moving things would change it
+	//		2. how far each particle moves, from its and its neighbours' lambdas
+	//		3. move them
+	//
+	// only compression is corrected, so particles at the surface aren't pulled into clumps. each pass only reads what
+	// the previous one wrote, so the particles are independent within a pass
+	void LiquidSystem::solveDensity(const Component::Liquid& liquid)
+	{
+		const size_t count = liquid.size();
+		const float h2 = m_h * m_h;
+
+		for (uint32_t iteration = 0; iteration < liquid.iterations; iteration++) {
+			m_threadPool->parallelFor(count,
+				[&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						const float xi = m_predX[i];
+						const float yi = m_predY[i];
+
+						float density = 0.f;
+						float gradX = 0.f;
+						float gradY = 0.f;
+						float grad2 = 0.f;
+
+						forEachNeighbour(xi, yi, [&](uint32_t j) {
+							float dx = xi - m_predX[j];
+							float dy = yi - m_predY[j];
+							float r2 = dx * dx + dy * dy;
+							if (r2 >= h2) return;
+
+							float d = h2 - r2;
+							density += m_poly6 * d * d * d;
+
+							if (j == i || r2 < EPSILON) return;
+
+							float r = std::sqrt(r2);
+							float g = m_spiky * (m_h - r) * (m_h - r) / r * m_invRest;
+							gradX += g * dx;
+							gradY += g * dy;
+							grad2 += g * g * r2;
+							});
+
+						float constraint = std::max(density * m_invRest - 1.f, 0.f);
+						m_lambda[i] = -constraint / (grad2 + gradX * gradX + gradY * gradY + m_epsilon);
+					}
+				}, PARTICLE_GRAIN);
+
+			m_threadPool->parallelFor(count,
+				[&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						const float xi = m_predX[i];
+						const float yi = m_predY[i];
+						const float lambdaI = m_lambda[i];
+
+						float moveX = 0.f;
+						float moveY = 0.f;
+
+						forEachNeighbour(xi, yi, [&](uint32_t j) {
+							if (j == i) return;
+
+							float dx = xi - m_predX[j];
+							float dy = yi - m_predY[j];
+							float r2 = dx * dx + dy * dy;
+							if (r2 >= h2 || r2 < EPSILON) return;
+
+							float d = h2 - r2;
+							float w = m_poly6 * d * d * d / m_corrW;
+							float tensile = -TENSILE_K * w * w * w * w;
+
+							float r = std::sqrt(r2);
+							float g = m_spiky * (m_h - r) * (m_h - r) / r;
+							float s = (lambdaI + m_lambda[j] + tensile) * g;
+							moveX += s * dx;
+							moveY += s * dy;
+							});
+
+						m_deltaX[i] = moveX * m_invRest;
+						m_deltaY[i] = moveY * m_invRest;
+					}
+				}, PARTICLE_GRAIN);
+
+			m_threadPool->parallelFor(count,
+				[&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						m_predX[i] += m_deltaX[i];
+						m_predY[i] += m_deltaY[i];
+					}
+				}, PARTICLE_GRAIN);
+		}
+	}
+
+	// 4. COLLISIONS
+	//		- soft bodies whose group and mask agree with ours, from the soft body grid. one at a time as particles push back
+	//		  on their points, looking only at the particles in the cells under each
+	//		- then static colliders, heightfields and the world bounds, which nothing moves, so in parallel
+	void LiquidSystem::collide(Component::Liquid& liquid, int collisionGroup, int collisionMask, float dt)
+	{
+		const size_t count = liquid.size();
+
+		wf::BoundingBox reach = liquid.boundingBox;
+		reach.extend(reach.min - wf::Vec3(m_h));
+		reach.extend(reach.max + wf::Vec3(m_h));
+
+		m_queryResults.clear();
+		m_physics->queryRegion(reach, m_queryResults, { collisionGroup, collisionMask });
+
+		m_bodies.clear();
+		for (auto id : m_queryResults) {
+			m_bodies.push_back(&entityManager->get(id).getComponent<Component::SoftBody>());
+		}
+
+		m_statics.clear();
+		entityManager->each<Component::StaticCollider>(
+			[&](const Component::StaticCollider& fixture) {
+				if (fixture.boundingBox.intersects(reach)) m_statics.push_back(&fixture);
+			});
+
+		m_heightfields.clear();
+		entityManager->each<Component::HeightfieldCollider>(
+			[&](const Component::HeightfieldCollider& ground) {
+				if (ground.field.isValid()) m_heightfields.push_back(&ground.field);
+			});
+
+		for (auto* body : m_bodies) {
+			const auto& box = body->boundingBox;
+			bool touched = false;
+
+			forEachParticleIn(box, [&](uint32_t i) {
+				if (m_predX[i] < box.min.x || m_predX[i] > box.max.x || m_predY[i] < box.min.y || m_predY[i] > box.max.y) return;
+
+				wf::Vec2 to = { m_predX[i], m_predY[i] };
+				if (m_collider.collideParticle({ liquid.posX[i], liquid.posY[i] }, to, liquid.particleMass, dt, *body)) {
+					m_predX[i] = to.x;
+					m_predY[i] = to.y;
+					touched = true;
+				}
+				});
+
+			// liquid landing on a sleeper is enough to disturb it; it'll be pushed from the next step
+			if (touched && body->sleeping) body->wake();
+		}
+
+		// same as the soft bodies; with ground about, the bounds aren't the floor
+		auto worldBounds = Config::get().worldBounds;
+		if (!m_heightfields.empty()) worldBounds.min.y = -FLT_MAX;
+
+		m_threadPool->parallelFor(count,
+			[&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					wf::Vec2 from = { liquid.posX[i], liquid.posY[i] };
+					wf::Vec2 to = { m_predX[i], m_predY[i] };
+
+					for (const auto* fixture : m_statics) {
+						m_collider.collideParticle(from, to, *fixture);
+					}
+
+					for (const auto* field : m_heightfields) {
+						to.y = std::max(to.y, field->getHeight(to.x, 0.f));
+					}
+
+					if (worldBounds.isValid) {
+						to.x = std::clamp(to.x, worldBounds.min.x, worldBounds.max.x);
+						to.y = std::clamp(to.y, worldBounds.min.y, worldBounds.max.y);
+					}
+
+					m_predX[i] = to.x;
+					m_predY[i] = to.y;
+				}
+			}, PARTICLE_GRAIN);
+	}
+
+	// 5. FINISH
+	//		1. velocity = (prediction - position) / dt
+	//		2. XSPH viscosity: nudge each velocity towards the neighbours', weighted by the density kernel
+	//		3. position = prediction
+	void LiquidSystem::finish(Component::Liquid& liquid, float dt)
+	{
+		const size_t count = liquid.size();
+		const float h2 = m_h * m_h;
+		const float invDt = 1.f / dt;
+
+		m_threadPool->parallelFor(count,
+			[&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					liquid.velX[i] = (m_predX[i] - liquid.posX[i]) * invDt;
+					liquid.velY[i] = (m_predY[i] - liquid.posY[i]) * invDt;
+				}
+			}, PARTICLE_GRAIN);
+
+		if (liquid.viscosity > 0.f) {
+			const float viscosity = liquid.viscosity * m_invRest;
+
+			m_threadPool->parallelFor(count,
+				[&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						const float xi = m_predX[i];
+						const float yi = m_predY[i];
+
+						float blendX = 0.f;
+						float blendY = 0.f;
+
+						forEachNeighbour(xi, yi, [&](uint32_t j) {
+							float dx = xi - m_predX[j];
+							float dy = yi - m_predY[j];
+							float r2 = dx * dx + dy * dy;
+							if (r2 >= h2) return;
+
+							float d = h2 - r2;
+							float w = m_poly6 * d * d * d;
+							blendX += (liquid.velX[j] - liquid.velX[i]) * w;
+							blendY += (liquid.velY[j] - liquid.velY[i]) * w;
+							});
+
+						m_deltaX[i] = blendX * viscosity;
+						m_deltaY[i] = blendY * viscosity;
+					}
+				}, PARTICLE_GRAIN);
+		}
+		else {
+			std::fill(m_deltaX.begin(), m_deltaX.end(), 0.f);
+			std::fill(m_deltaY.begin(), m_deltaY.end(), 0.f);
+		}
+
+		m_threadPool->parallelFor(count,
+			[&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					liquid.velX[i] += m_deltaX[i];
+					liquid.velY[i] += m_deltaY[i];
+					liquid.posX[i] = m_predX[i];
+					liquid.posY[i] = m_predY[i];
+				}
+			}, PARTICLE_GRAIN);
+	}
+
+	// RENDER PREP: one quad per particle, all in one mesh so the whole liquid is a single draw. the mesh only grows,
+	// doubling when it needs to, with the spare quads collapsed to nothing
+	void LiquidSystem::updateMesh(const Component::Liquid& liquid, wf::MeshRendererComponent& meshRenderer)
+	{
+		if (!meshRenderer.mesh) {
+			meshRenderer.mesh = wf::Mesh::create();
+			meshRenderer.mesh->isDynamic = true;
+		}
+
+		auto& mesh = *meshRenderer.mesh;
+		meshRenderer.material.diffuse.colour = liquid.colour;
+
+		const size_t count = liquid.size();
+		size_t capacity = mesh.vertices.size() / 4;
+
+		if (count > capacity) {
+			capacity = std::max({ capacity * 2, count, size_t(256) });
+
+			// the buffers can't grow in place; the render system makes new ones when there aren't any
+			if (mesh.buffers.vao) {
+				wf::wgl::destroyMeshBuffers(mesh.buffers);
+				mesh.buffers = {};
+			}
+
+			const wf::Vec2 corners[4] = { { 0.f, 0.f }, { 1.f, 0.f }, { 1.f, 1.f }, { 0.f, 1.f } };
+
+			mesh.vertices.resize(capacity * 4);
+			mesh.indices.resize(capacity * 6);
+			for (size_t q = 0; q < capacity; q++) {
+				for (size_t c = 0; c < 4; c++) {
+					auto& vert = mesh.vertices[q * 4 + c];
+					vert.normal = { 0.f, 0.f, 1.f };
+					vert.colour = wf::WHITE;
+					vert.texcoord = corners[c];
+					vert.tangent = { 1.f, 0.f, 0.f, 1.f };
+				}
+
+				unsigned int base = static_cast<unsigned int>(q * 4);
+				unsigned int* idx = &mesh.indices[q * 6];
+				idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+				idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+			}
+		}
+
+		// a touch bigger than the particles themselves so the surface reads as continuous
+		const float size = liquid.particleRadius * 1.5f;
+		const wf::Vec2 offsets[4] = { { -size, -size }, { size, -size }, { size, size }, { -size, size } };
+
+		for (size_t q = 0; q < capacity; q++) {
+			wf::Vec2 centre = q < count ? wf::Vec2{ liquid.posX[q], liquid.posY[q] } : wf::Vec2{};
+			float scale = q < count ? 1.f : 0.f;
+
+			for (size_t c = 0; c < 4; c++) {
+				mesh.vertices[q * 4 + c].position = wf::Vec3(centre + offsets[c] * scale, 0.f);
+			}
+		}
+
+		mesh.needsUpdate = true;
+	}
+
+	uint32_t LiquidSystem::cellKey(int x, int y) const
+	{
+		return ((static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u)) & m_gridMask;
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "Engine.h"
+
+#include "Component/LiquidComponent.h"
+#include "Utils/Collider.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Squishies
+{
+	class SoftBodySystem;
+
+	/**
+	 * @brief Position based fluids for the Liquid components, pushing and pushed by the soft bodies and the level.
+	 *
+	 * Each step the particles are binned into a uniform grid and physically sorted by cell, so a particle's neighbours
+	 * are next to it in memory. Density is then solved as a position constraint per particle, spread over the soft body
+	 * system's thread pool, and whatever's left inside something solid afterwards is pushed back out.
+	 */
+	class LiquidSystem : public wf::ISystem
+	{
+	public:
+		LiquidSystem(wf::Scene* scene, SoftBodySystem* physics);
+
+		virtual bool init() override;
+		virtual void update(float dt) override;
+		virtual void fixedUpdate(float dt) override;
+
+	private:
+		static constexpr size_t PARTICLE_GRAIN = 256;				// min particles per parallel chunk
+
+		void simulate(Component::Liquid& liquid, int collisionGroup, int collisionMask, float dt);
+		void predict(Component::Liquid& liquid, float dt);
+		void buildGrid(Component::Liquid& liquid);
+		void solveDensity(const Component::Liquid& liquid);
+		void collide(Component::Liquid& liquid, int collisionGroup, int collisionMask, float dt);
+		void finish(Component::Liquid& liquid, float dt);
+		void updateMesh(const Component::Liquid& liquid, wf::MeshRendererComponent& meshRenderer);
+
+		uint32_t cellKey(int x, int y) const;
+
+		/**
+		 * @brief Call fn(j) for every particle j (including i itself) in the cells around a point
+		 */
+		template<typename Fn>
+		void forEachNeighbour(float x, float y, Fn&& fn) const;
+
+		/**
+		 * @brief Call fn(j) for every particle j binned in the cells under a box, or a cell either side of it, in order
+		 */
+		template<typename Fn>
+		void forEachParticleIn(const wf::BoundingBox& box, Fn&& fn);
+
+	private:
+		SoftBodySystem* m_physics{ nullptr };
+		Collider m_collider;
+		wf::ThreadPool* m_threadPool{ nullptr };					// the soft bodies', for the step
+
+		// kernels, for the liquid being stepped
+		float m_h{ 1.f };											// kernel radius, and grid cell size
+		float m_invH{ 1.f };
+		float m_poly6{ 0.f };										// density kernel coefficient
+		float m_spiky{ 0.f };										// pressure gradient kernel coefficient
+		float m_invRest{ 0.f };										// 1 / summed kernel at rest, i.e. mass / rest density
+		float m_epsilon{ 0.f };										// constraint relaxation
+		float m_corrW{ 1.f };										// kernel at the tensile correction's reference distance
+
+		// neighbour grid; particles are sorted by cell so each cell is one run of them
+		uint32_t m_gridMask{ 0 };
+		std::vector<uint32_t> m_keys;								// cell per particle
+		std::vector<uint32_t> m_cellStart;							// per cell, first particle; one extra on the end
+		std::vector<uint32_t> m_order;								// sorted position -> original particle
+		std::vector<float> m_scratch;								// for reordering
+		std::vector<uint32_t> m_visitKeys;							// cells under a body
+
+		// per particle working state
+		std::vector<float> m_predX, m_predY;						// predicted positions
+		std::vector<float> m_lambda;
+		std::vector<float> m_deltaX, m_deltaY;
+
+		std::vector<wf::EntityID> m_queryResults;
+		std::vector<Component::SoftBody*> m_bodies;				// soft bodies the current liquid can touch
+		std::vector<const Component::StaticCollider*> m_statics;
+		std::vector<const wf::Heightfield*> m_heightfields;
+	};
+
+	template<typename Fn>
+	void LiquidSystem::forEachNeighbour(float x, float y, Fn&& fn) const
+	{
+		const int cx = static_cast<int>(std::floor(x * m_invH));
+		const int cy = static_cast<int>(std::floor(y * m_invH));
+
+		// neighbouring cells can hash to the same bucket; visit each bucket once
+		uint32_t seen[9];
+		int seenCount = 0;
+
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				uint32_t key = cellKey(cx + dx, cy + dy);
+
+				bool repeat = false;
+				for (int s = 0; s < seenCount; s++) {
+					repeat |= seen[s] == key;
+				}
+				if (repeat) continue;
+				seen[seenCount++] = key;
+
+				for (uint32_t j = m_cellStart[key]; j < m_cellStart[key + 1]; j++) {
+					fn(j);
+				}
+			}
+		}
+	}
+
+	template<typename Fn>
+	void LiquidSystem::forEachParticleIn(const wf::BoundingBox& box, Fn&& fn)
+	{
+		const int minX = static_cast<int>(std::floor(box.min.x * m_invH)) - 1;
+		const int minY = static_cast<int>(std::floor(box.min.y * m_invH)) - 1;
+		const int maxX = static_cast<int>(std::floor(box.max.x * m_invH)) + 1;
+		const int maxY = static_cast<int>(std::floor(box.max.y * m_invH)) + 1;
+
+		// more cells than buckets; everything's under it somewhere, so just go through the lot
+		if ((double(maxX) - minX + 1) * (double(maxY) - minY + 1) > m_gridMask) {
+			for (uint32_t j = 0; j < m_order.size(); j++) {
+				fn(j);
+			}
+			return;
+		}
+
+		// cells can share a bucket; visit each once, and in order, as the particles are sorted by it
+		m_visitKeys.clear();
+		for (int y = minY; y <= maxY; y++) {
+			for (int x = minX; x <= maxX; x++) {
+				m_visitKeys.push_back(cellKey(x, y));
+			}
+		}
+		std::sort(m_visitKeys.begin(), m_visitKeys.end());
+		m_visitKeys.erase(std::unique(m_visitKeys.begin(), m_visitKeys.end()), m_visitKeys.end());
+
+		for (uint32_t key : m_visitKeys) {
+			for (uint32_t j = m_cellStart[key]; j < m_cellStart[key + 1]; j++) {
+				fn(j);
+			}
+		}
+	}
+}
@@ -71,23 +71,20 @@ namespace Squishies
 
 	void MovementSystem::applyMovement(Component::SoftBody& squishy, float movement)
 	{
-		for (auto& pt : squishy.points) {
-			pt.force.x += movement * 10.f;
-		}
+		squishy.wake();
+		squishy.points.addForces({ movement * 10.f, 0.f, 0.f });
 	}
 
 	void MovementSystem::applyJump(Component::SoftBody& squishy)
 	{
-		for (auto& pt : squishy.points) {
-			pt.force.y += 500.f;
-		}
+		squishy.wake();
+		squishy.points.addForces({ 0.f, 500.f, 0.f });
 	}
 
 	void MovementSystem::applyDuck(Component::SoftBody& squishy)
 	{
-		for (auto& pt : squishy.points) {
-			pt.force.y -= 500.f;
-		}
+		squishy.wake();
+		squishy.points.addForces({ 0.f, -500.f, 0.f });
 	}
 
 	void MovementSystem::deployWeapon(wf::Entity player, Component::SoftBody& squishy, Component::Inventory& inventory, const wf::Vec3& target)
@@ -0,0 +1,345 @@
+#include "RigidBodySystem.h"
+
+#include "Component/ColliderComponent.h"
+#include "Component/RigidBodyComponent.h"
+#include "Component/SoftBodyComponent.h"
+#include "Component/StaticColliderComponent.h"
+#include "Config.h"
+#include "Poly/Squishy.h"
+#include "System/SoftBodySystem.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace Squishies
+{
+	namespace
+	{
+		constexpr float LEVEL_DEPTH = 2.f;							// thickness of the mirrored level geometry
+
+		btTransform toBullet(const wf::Transform& transform)
+		{
+			btTransform out;
+			out.setIdentity();
+			out.setOrigin(btVector3(transform.position.x, transform.position.y, 0.f));
+			out.setRotation(btQuaternion(btVector3(0.f, 0.f, 1.f), transform.rotation.z * DEG2RAD));
+			return out;
+		}
+
+		void getGroupAndMask(wf::Entity entity, int& collisionGroup, int& collisionMask)
+		{
+			collisionGroup = CollisionGroup::DEFAULT;
+			collisionMask = CollisionGroup::ALL;
+
+			if (entity.hasComponent<Component::Collider>()) {
+				const auto& collider = entity.getComponent<Component::Collider>();
+				collisionGroup = collider.collisionGroup;
+				collisionMask = collider.collisionMask;
+			}
+		}
+	}
+
+	RigidBodySystem::BulletObject::BulletObject() = default;
+	RigidBodySystem::BulletObject::BulletObject(BulletObject&&) noexcept = default;
+	RigidBodySystem::BulletObject::~BulletObject() = default;
+
+	RigidBodySystem::RigidBodySystem(wf::Scene* scene, SoftBodySystem* physics)
+		:ISystem(scene), m_physics(physics), m_collider(scene->getEventDispatcher())
+	{
+		// the soft bodies and ours trade impulses every step, so they have to be stepped alongside us
+		m_physics->addCoupledSystem();
+
+		m_collisionConfig = std::make_unique<btDefaultCollisionConfiguration>();
+		m_dispatcher = std::make_unique<btCollisionDispatcher>(m_collisionConfig.get());
+		m_broadphase = std::make_unique<btDbvtBroadphase>();
+		m_solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+		m_world = std::make_unique<btDiscreteDynamicsWorld>(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
+
+		m_world->setGravity(btVector3(0.f, Config::get().gravity, 0.f));
+	}
+
+	RigidBodySystem::~RigidBodySystem()
+	{
+		// the world still refers to anything in it, so everything has to come out before any of it goes
+		for (auto& [id, object] : m_bodies) removeObject(object);
+		for (auto& [id, object] : m_level) removeObject(object);
+		for (auto& object : m_bounds) removeObject(object);
+	}
+
+	bool RigidBodySystem::init()
+	{
+		createWorldBounds();
+
+		entityManager->onCreate<Component::RigidBody>([&](wf::Entity entity) {
+			createRigidBody(entity);
+			});
+
+		entityManager->onRemove<Component::RigidBody>([&](wf::Entity entity) {
+			auto it = m_bodies.find(entity.handle);
+			if (it == m_bodies.end()) return;
+
+			removeObject(it->second);
+			m_bodies.erase(it);
+			});
+
+		entityManager->onCreate<Component::StaticCollider>([&](wf::Entity entity) {
+			createLevelGeometry(entity);
+			});
+
+		entityManager->onRemove<Component::StaticCollider>([&](wf::Entity entity) {
+			auto it = m_level.find(entity.handle);
+			if (it == m_level.end()) return;
+
+			removeObject(it->second);
+			m_level.erase(it);
+			});
+
+		return true;
+	}
+
+	// a step:
+	//		1. move static and kinematic bodies to their transforms
+	//		2. step Bullet
+	//		3. dynamic bodies' transforms from Bullet, and everyone's velocities and outlines
+	//		4. push soft bodies out of the rigid outlines, giving the rigid bodies the impulses for the next step
+	void RigidBodySystem::fixedUpdate(float dt)
+	{
+		syncToBullet();
+
+		// we're already on a fixed step, so exactly one Bullet step of the same length
+		m_world->stepSimulation(dt, 0);
+
+		syncFromBullet();
+		collideSoftBodies();
+	}
+
+	// 0. BUILD: the convex hull of the shape, extruded through the plane, and kept on it
+	void RigidBodySystem::createRigidBody(wf::Entity entity)
+	{
+		auto& rigid = entity.getComponent<Component::RigidBody>();
+		auto& transform = entity.getComponent<wf::TransformComponent>();
+
+		rigid.build(transform);
+
+		// Bullet has no scale on its transforms, so it goes into the points. the transform's position is the centre of mass
+		auto hull = std::make_unique<btConvexHullShape>();
+		for (const auto& pt : rigid.shape.points) {
+			float x = pt.x * transform.scale.x;
+			float y = pt.y * transform.scale.y;
+			hull->addPoint(btVector3(x, y, -rigid.depth * .5f));
+			hull->addPoint(btVector3(x, y, rigid.depth * .5f));
+		}
+		hull->optimizeConvexHull();
+
+		const bool dynamic = rigid.type == Component::RigidBody::Type::DYNAMIC;
+		const float mass = dynamic ? rigid.mass : 0.f;
+
+		btVector3 inertia(0.f, 0.f, 0.f);
+		if (dynamic) hull->calculateLocalInertia(mass, inertia);
+
+		BulletObject object;
+		object.motionState = std::make_unique<btDefaultMotionState>(toBullet(transform));
+
+		btRigidBody::btRigidBodyConstructionInfo info(mass, object.motionState.get(), hull.get(), inertia);
+		info.m_friction = rigid.friction;
+		info.m_restitution = rigid.restitution;
+
+		object.shape = std::move(hull);
+		object.body = std::make_unique<btRigidBody>(info);
+
+		// everything stays on the plane, turning only about the axis through it
+		object.body->setLinearFactor(btVector3(1.f, 1.f, 0.f));
+		object.body->setAngularFactor(btVector3(0.f, 0.f, 1.f));
+
+		if (rigid.type == Component::RigidBody::Type::KINEMATIC) {
+			object.body->setCollisionFlags(object.body->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+			object.body->setActivationState(DISABLE_DEACTIVATION);
+		}
+
+		int collisionGroup, collisionMask;
+		getGroupAndMask(entity, collisionGroup, collisionMask);
+		addObject(object, collisionGroup, collisionMask);
+
+		m_bodies.emplace(entity.handle, std::move(object));
+
+		// dynamic bodies only move in the fixed steps, so they're drawn between the last two
+		if (dynamic && !entity.hasComponent<wf::PreviousTransformComponent>()) {
+			entity.addComponent<wf::PreviousTransformComponent>(transform);
+		}
+
+		// the mesh stays relative to the transform, which we move
+		if (entity.hasComponent<wf::MeshRendererComponent>()) {
+			auto& meshRenderer = entity.getComponent<wf::MeshRendererComponent>();
+			if (!meshRenderer.mesh) {
+				meshRenderer.mesh = Squishy(rigid.shape).createMesh();
+			}
+		}
+	}
+
+	// 0b. BUILD LEVEL: static colliders as walls along their edges, so concave shapes and open lines come out exact
+	void RigidBodySystem::createLevelGeometry(wf::Entity entity)
+	{
+		const auto& fixture = entity.getComponent<Component::StaticCollider>();
+		const auto& transform = entity.getComponent<wf::TransformComponent>();
+
+		Poly world = fixture.shape.getTransformed(transform);
+		const size_t pointCount = world.points.size();
+		const size_t edgeCount = fixture.closed ? pointCount : (pointCount > 0 ? pointCount - 1 : 0);
+
+		auto mesh = std::make_unique<btTriangleMesh>();
+		for (size_t i = 0; i < edgeCount; i++) {
+			const auto& p1 = world.points[i];
+			const auto& p2 = world.points[(i + 1) % pointCount];
+
+			btVector3 a(p1.x, p1.y, -LEVEL_DEPTH * .5f);
+			btVector3 b(p2.x, p2.y, -LEVEL_DEPTH * .5f);
+			btVector3 c(p2.x, p2.y, LEVEL_DEPTH * .5f);
+			btVector3 d(p1.x, p1.y, LEVEL_DEPTH * .5f);
+
+			mesh->addTriangle(a, b, c);
+			mesh->addTriangle(a, c, d);
+		}
+
+		if (!mesh->getNumTriangles()) return;
+
+		BulletObject object;
+		object.shape = std::make_unique<btBvhTriangleMeshShape>(mesh.get(), true);
+		object.mesh = std::move(mesh);
+		object.motionState = std::make_unique<btDefaultMotionState>();
+
+		btRigidBody::btRigidBodyConstructionInfo info(0.f, object.motionState.get(), object.shape.get());
+		object.body = std::make_unique<btRigidBody>(info);
+
+		addObject(object, CollisionGroup::STATIC, CollisionGroup::ALL);
+		m_level.emplace(entity.handle, std::move(object));
+	}
+
+	// 0c. BOUNDS: a plane for each side of the world bounds, same as the soft bodies are kept in by
+	void RigidBodySystem::createWorldBounds()
+	{
+		const auto& bounds = Config::get().worldBounds;
+		if (!bounds.isValid) return;
+
+		const std::pair<btVector3, float> planes[] = {
+			{ btVector3(0.f, 1.f, 0.f), bounds.min.y },
+			{ btVector3(0.f, -1.f, 0.f), -bounds.max.y },
+			{ btVector3(1.f, 0.f, 0.f), bounds.min.x },
+			{ btVector3(-1.f, 0.f, 0.f), -bounds.max.x },
+		};
+
+		for (const auto& [normal, offset] : planes) {
+			BulletObject object;
+			object.shape = std::make_unique<btStaticPlaneShape>(normal, offset);
+			object.motionState = std::make_unique<btDefaultMotionState>();
+
+			btRigidBody::btRigidBodyConstructionInfo info(0.f, object.motionState.get(), object.shape.get());
+			object.body = std::make_unique<btRigidBody>(info);
+
+			addObject(object, CollisionGroup::STATIC, CollisionGroup::ALL);
+			m_bounds.push_back(std::move(object));
+		}
+	}
+
+	void RigidBodySystem::addObject(BulletObject& object, int collisionGroup, int collisionMask)
+	{
+		m_world->addRigidBody(object.body.get(), collisionGroup, collisionMask);
+	}
+
+	void RigidBodySystem::removeObject(BulletObject& object)
+	{
+		if (object.body) m_world->removeRigidBody(object.body.get());
+	}
+
+	// 1. TO BULLET: Bullet picks kinematic bodies up from their motion states, and works out their velocities from it
+	void RigidBodySystem::syncToBullet()
+	{
+		entityManager->each<Component::RigidBody, wf::TransformComponent>(
+			[&](wf::EntityID id, Component::RigidBody& rigid, wf::TransformComponent& transform) {
+				if (rigid.type != Component::RigidBody::Type::KINEMATIC) return;
+
+				auto it = m_bodies.find(id);
+				if (it == m_bodies.end()) return;
+
+				it->second.motionState->setWorldTransform(toBullet(transform));
+			});
+	}
+
+	// 3. FROM BULLET
+	void RigidBodySystem::syncFromBullet()
+	{
+		entityManager->each<Component::RigidBody, wf::TransformComponent>(
+			[&](wf::EntityID id, Component::RigidBody& rigid, wf::TransformComponent& transform) {
+				auto it = m_bodies.find(id);
+				if (it == m_bodies.end()) return;
+
+				const btRigidBody& body = *it->second.body;
+				const btTransform& world = body.getWorldTransform();
+
+				if (rigid.type == Component::RigidBody::Type::DYNAMIC) {
+					btScalar yaw, pitch, roll;
+					world.getBasis().getEulerZYX(yaw, pitch, roll);
+
+					transform.position.x = world.getOrigin().x();
+					transform.position.y = world.getOrigin().y();
+					transform.rotation.z = yaw * RAD2DEG;
+				}
+
+				rigid.centre = { world.getOrigin().x(), world.getOrigin().y() };
+				rigid.linearVelocity = { body.getLinearVelocity().x(), body.getLinearVelocity().y() };
+				rigid.angularVelocity = body.getAngularVelocity().z();
+				rigid.invMass = body.getInvMass();
+				rigid.invInertia = body.getInvInertiaTensorWorld()[2][2];
+
+				// statics were placed when they were made and haven't gone anywhere
+				if (rigid.type != Component::RigidBody::Type::STATIC) {
+					rigid.build(transform);
+				}
+			});
+	}
+
+	// 4. SOFT BODIES: foreach rigid body, each soft body under its box that its group and mask agree with, from the soft
+	// body grid. one at a time, as they all add to the same impulses
+	void RigidBodySystem::collideSoftBodies()
+	{
+		const float sleepEnergy = Config::get().sleepEnergy;
+
+		entityManager->each<Component::RigidBody>(
+			[&](wf::EntityID id, Component::RigidBody& rigid) {
+				auto it = m_bodies.find(id);
+				if (it == m_bodies.end()) return;
+
+				int collisionGroup, collisionMask;
+				getGroupAndMask(entityManager->get(id), collisionGroup, collisionMask);
+
+				// anything moving enough to keep a soft body awake is enough to wake one
+				const float radius = glm::length(wf::Vec2(rigid.boundingBox.size())) * .5f;
+				const float speed = glm::length(rigid.linearVelocity) + std::abs(rigid.angularVelocity) * radius;
+				const bool moving = .5f * speed * speed > sleepEnergy;
+
+				wf::Vec2 linearImpulse{};
+				float angularImpulse = 0.f;
+
+				m_nearby.clear();
+				m_physics->queryRegion(rigid.boundingBox, m_nearby, { collisionGroup, collisionMask });
+
+				for (auto softbodyId : m_nearby) {
+					auto& softbody = entityManager->get(softbodyId).getComponent<Component::SoftBody>();
+					if (!m_collider.collideRigid(softbody, rigid, linearImpulse, angularImpulse)) continue;
+
+					// held still while asleep or at low detail; being shoved about brings it back
+					if ((softbody.sleeping || softbody.lodSkipped) && moving) softbody.wake();
+				}
+
+				if (rigid.type != Component::RigidBody::Type::DYNAMIC) return;
+				if (linearImpulse == wf::Vec2{} && angularImpulse == 0.f) return;
+
+				btRigidBody& body = *it->second.body;
+				body.activate();
+				body.applyCentralImpulse(btVector3(linearImpulse.x, linearImpulse.y, 0.f));
+				body.applyTorqueImpulse(btVector3(0.f, 0.f, angularImpulse));
+			});
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Engine.h"
+
+#include "Utils/Collider.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class btBroadphaseInterface;
+class btCollisionDispatcher;
+class btCollisionShape;
+class btDefaultCollisionConfiguration;
+class btDiscreteDynamicsWorld;
+class btMotionState;
+class btRigidBody;
+class btSequentialImpulseConstraintSolver;
+class btTriangleMesh;
+
+namespace Squishies
+{
+	class SoftBodySystem;
+
+	/**
+	 * @brief Rigid bodies through Bullet, on the same plane as the soft bodies.
+	 *
+	 * Each step the static and kinematic bodies are moved to where their transforms say, Bullet steps, and dynamic bodies'
+	 * transforms are updated from it. Then the soft bodies are pushed out of the rigid outlines, with the impulses going
+	 * back to Bullet for the next step. Static colliders and the world bounds are mirrored into Bullet so that rigid
+	 * bodies land on the same level the soft bodies do.
+	 */
+	class RigidBodySystem : public wf::ISystem
+	{
+	public:
+		RigidBodySystem(wf::Scene* scene, SoftBodySystem* physics);
+		~RigidBodySystem();
+
+		virtual bool init() override;
+		virtual void fixedUpdate(float dt) override;
+
+	private:
+		/**
+		 * @brief Everything Bullet needs for one object. Bullet doesn't own any of it
+		 */
+		struct BulletObject
+		{
+			std::unique_ptr<btTriangleMesh> mesh;					// for static level geometry only
+			std::unique_ptr<btCollisionShape> shape;
+			std::unique_ptr<btMotionState> motionState;
+			std::unique_ptr<btRigidBody> body;
+
+			BulletObject();
+			BulletObject(BulletObject&&) noexcept;
+			~BulletObject();
+		};
+
+		void createRigidBody(wf::Entity entity);
+		void createLevelGeometry(wf::Entity entity);
+		void createWorldBounds();
+		void addObject(BulletObject& object, int collisionGroup, int collisionMask);
+		void removeObject(BulletObject& object);
+		void syncToBullet();
+		void syncFromBullet();
+		void collideSoftBodies();
+
+	private:
+		SoftBodySystem* m_physics{ nullptr };						// for the soft bodies near each rigid one
+		Collider m_collider;
+		std::vector<wf::EntityID> m_nearby;
+
+		std::unique_ptr<btDefaultCollisionConfiguration> m_collisionConfig;
+		std::unique_ptr<btCollisionDispatcher> m_dispatcher;
+		std::unique_ptr<btBroadphaseInterface> m_broadphase;
+		std::unique_ptr<btSequentialImpulseConstraintSolver> m_solver;
+		std::unique_ptr<btDiscreteDynamicsWorld> m_world;
+
+		std::unordered_map<wf::EntityID, BulletObject> m_bodies;	// per RigidBody entity
+		std::unordered_map<wf::EntityID, BulletObject> m_level;		// per StaticCollider entity
+		std::vector<BulletObject> m_bounds;							// walls for the world bounds
+	};
+}
@@ -0,0 +1,263 @@
+#include "SoftBodyRenderSystem.h"
+
+#include "Component/SoftBodyComponent.h"
+#include "System/SoftBodySystem.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Squishies
+{
+	SoftBodyRenderSystem::SoftBodyRenderSystem(wf::Scene* scene, SoftBodySystem* physics)
+		:ISystem(scene), m_physics(physics)
+	{
+	}
+
+	bool SoftBodyRenderSystem::init()
+	{
+		return true;
+	}
+
+	void SoftBodyRenderSystem::teardown()
+	{
+		// the entities go with the scene, and their buffers with the render system
+		m_batches.clear();
+	}
+
+	// 1. gather every visible body into the batch for its material
+	// 2. lay out again any batch whose bodies have changed
+	// 3. write the positions of everything that's moved
+	void SoftBodyRenderSystem::update(float dt)
+	{
+		for (auto& batch : m_batches) {
+			batch.next.clear();
+			batch.bodies.clear();
+		}
+
+		entityManager->each<Component::SoftBody, wf::MeshRendererComponent>(
+			[&](wf::EntityID id, const Component::SoftBody& softbody, const wf::MeshRendererComponent& meshRenderer) {
+				// the render system loads the shader; until it has, there's nothing to share
+				if (!meshRenderer.material.visible || !meshRenderer.material.shader.handle.glId) return;
+
+				auto& batch = findBatch(meshRenderer.material);
+				batch.next.push_back({ id, softbody.shape.get(), softbody.colour });
+				batch.bodies.push_back(&softbody);
+			});
+
+		for (auto& batch : m_batches) {
+			if (batch.next != batch.members) {
+				batch.members.swap(batch.next);
+				layout(batch);
+			}
+
+			writePositions(batch);
+		}
+	}
+
+	bool SoftBodyRenderSystem::canShare(const wf::Material& a, const wf::Material& b)
+	{
+		return a.shader.handle.glId == b.shader.handle.glId
+			&& a.diffuse.map.handle.glId == b.diffuse.map.handle.glId
+			&& a.normal.map.handle.glId == b.normal.map.handle.glId
+			&& a.normal.strength == b.normal.strength
+			&& a.specular.map.handle.glId == b.specular.map.handle.glId
+			&& a.specular.colour == b.specular.colour
+			&& a.specular.shininess == b.specular.shininess
+			&& a.specular.intensity == b.specular.intensity
+			&& a.shadow.map.fbo == b.shadow.map.fbo
+			&& a.shadow.shadowPass == b.shadow.shadowPass
+			&& a.blendMode == b.blendMode
+			&& a.cullMode == b.cullMode
+			&& a.depthMask == b.depthMask
+			&& a.depthTest == b.depthTest
+			&& a.depthFunc == b.depthFunc
+			&& a.wireframe == b.wireframe;
+	}
+
+	SoftBodyRenderSystem::Batch& SoftBodyRenderSystem::findBatch(const wf::Material& material)
+	{
+		for (auto& batch : m_batches) {
+			if (canShare(batch.material, material)) return batch;
+		}
+
+		// a new batch gets an entity of its own for the render system to draw. the colour's in the vertices, so the
+		// material's is left white
+		auto& batch = m_batches.emplace_back();
+		batch.material = material;
+		batch.material.diffuse.colour = wf::WHITE;
+
+		auto entity = scene->createObject();
+		batch.entity = entity.handle;
+
+		auto& meshRenderer = entity.addComponent<wf::MeshRendererComponent>();
+		meshRenderer.material = batch.material;
+		meshRenderer.mesh = wf::Mesh::create();
+		meshRenderer.mesh->isDynamic = true;
+		meshRenderer.mesh->streamPositions = true;
+		meshRenderer.mesh->autoUpdate = false;				// we upload it ourselves, as and when
+
+		return batch;
+	}
+
+	// LAYOUT: each body's copy of its shape's template mesh one after the other, tinted with its colour. like the liquid,
+	// the mesh only grows, doubling when it needs to, with the spare triangles collapsed to nothing
+	void SoftBodyRenderSystem::layout(Batch& batch)
+	{
+		auto& mesh = *entityManager->get(batch.entity).getComponent<wf::MeshRendererComponent>().mesh;
+
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (const auto& member : batch.members) {
+			vertexCount += member.shape->mesh->vertices.size();
+			indexCount += member.shape->mesh->indices.size();
+		}
+
+		if (vertexCount > mesh.vertices.size() || indexCount > mesh.indices.size()) {
+			// the buffers can't grow in place
+			wf::wgl::destroyVertexStream(mesh.stream);
+			if (mesh.buffers.vao) {
+				wf::wgl::destroyMeshBuffers(mesh.buffers);
+				mesh.buffers = {};
+			}
+
+			mesh.vertices.resize(std::max({ mesh.vertices.size() * 2, vertexCount, size_t(256) }));
+			mesh.indices.resize(std::max({ mesh.indices.size() * 2, indexCount, size_t(768) }));
+		}
+
+		batch.firstVertex.resize(batch.members.size());
+		batch.unsettled.assign(batch.members.size(), wf::wgl::VertexStreamHandle::STREAM_REGIONS);
+
+		uint32_t v = 0;
+		size_t n = 0;
+		for (size_t m = 0; m < batch.members.size(); m++) {
+			const auto& member = batch.members[m];
+			const auto& shape = *member.shape->mesh;
+
+			batch.firstVertex[m] = v;
+
+			for (size_t i = 0; i < shape.vertices.size(); i++) {
+				auto& vert = mesh.vertices[v + i];
+				vert = shape.vertices[i];
+				vert.colour = {
+					vert.colour.r * member.colour.r,
+					vert.colour.g * member.colour.g,
+					vert.colour.b * member.colour.b,
+					vert.colour.a * member.colour.a
+				};
+			}
+
+			for (auto index : shape.indices) {
+				mesh.indices[n++] = v + index;
+			}
+
+			v += static_cast<uint32_t>(shape.vertices.size());
+		}
+		std::fill(mesh.indices.begin() + n, mesh.indices.end(), 0u);
+
+		// the render system has already been through this frame, so rather than leave it a batch it can't draw or one
+		// whose triangles don't match the positions, upload it now. the positions are only used to start the stream off;
+		// it has its own copies after that
+		if (!mesh.buffers.vao) {
+			mesh.buffers = wf::wgl::createMeshBuffers();
+			wf::wgl::uploadMeshData(mesh.buffers, mesh.vertices, mesh.indices, true);
+			mesh.stream = wf::wgl::createVertexStream(mesh.buffers, mesh.vertices);
+		}
+		else {
+			wf::wgl::updateMeshData(mesh.buffers, mesh.vertices, mesh.indices);
+		}
+		mesh.needsUpdate = false;
+	}
+
+	// POSITIONS: between the last two steps, as the bodies themselves would have been. the stream takes turns between
+	// its copies, so a body that's stopped still needs writing until every copy has caught up with it
+	void SoftBodyRenderSystem::writePositions(Batch& batch)
+	{
+		auto& mesh = *entityManager->get(batch.entity).getComponent<wf::MeshRendererComponent>().mesh;
+
+		// if the GPU still has the next copy of the stream we leave the last one up for a frame
+		wf::Vec3* out = wf::wgl::beginVertexStreamWrite(mesh.stream);
+		if (!out && mesh.stream.mapped) return;
+
+		const uint8_t copies = out ? wf::wgl::VertexStreamHandle::STREAM_REGIONS : 1;
+		const float fixedAlpha = wf::getFixedAlpha();
+
+		// with a simulation thread the bodies may be mid-step, so go from its snapshot. without one, read them directly
+		const auto* snapshot = m_physics->isSimulationThreaded() ? &m_physics->getSnapshot() : nullptr;
+
+		auto write = [&](size_t i, const wf::Vec3& pos) {
+			if (out) out[i] = pos;
+			else mesh.vertices[i].position = pos;
+		};
+
+		uint32_t first = std::numeric_limits<uint32_t>::max();
+		uint32_t end = 0;
+
+		for (size_t m = 0; m < batch.members.size(); m++) {
+			const auto& softbody = *batch.bodies[m];
+			const auto* state = snapshot ? snapshot->find(batch.members[m].id) : nullptr;
+
+			if (state ? state->sleeping : softbody.sleeping) {
+				if (!batch.unsettled[m]) continue;
+				batch.unsettled[m]--;
+			}
+			else {
+				batch.unsettled[m] = copies;
+			}
+
+			const uint32_t base = batch.firstVertex[m];
+			const uint32_t count = static_cast<uint32_t>(batch.members[m].shape->mesh->vertices.size());
+
+			if (state) {
+				// bodies that sat the last step out (asleep or at low detail) haven't got a step before to come from
+				const float alpha = state->stepped ? fixedAlpha : 1.f;
+				write(base, glm::mix(state->lastPosition, state->derivedPosition, alpha));
+
+				const uint32_t points = std::min(state->pointCount + 1, count);
+				for (uint32_t i = 1; i < points; i++) {
+					const size_t p = state->firstPoint + i - 1;
+					write(base + i, {
+						snapshot->lastX[p] + (snapshot->posX[p] - snapshot->lastX[p]) * alpha,
+						snapshot->lastY[p] + (snapshot->posY[p] - snapshot->lastY[p]) * alpha,
+						snapshot->lastZ[p] + (snapshot->posZ[p] - snapshot->lastZ[p]) * alpha
+						});
+				}
+			}
+			else if (snapshot) {
+				// created since the snapshot was taken. the simulation is never running during update, so read it directly
+				write(base, softbody.derivedPosition);
+				for (uint32_t i = 1; i < count; i++) {
+					write(base + i, softbody.points.getPosition(i - 1));
+				}
+			}
+			else {
+				// the same in between, straight from the points. the centre follows them, as the mean of where they're drawn
+				const auto& pts = softbody.points;
+				const float alpha = !softbody.sleeping && softbody.lodSteps == 0 ? fixedAlpha : 1.f;
+				const uint32_t points = std::min(static_cast<uint32_t>(pts.size()) + 1, count);
+
+				wf::Vec3 centre{};
+				for (uint32_t i = 1; i < points; i++) {
+					const size_t p = i - 1;
+					const wf::Vec3 pos = {
+						pts.lastX[p] + (pts.posX[p] - pts.lastX[p]) * alpha,
+						pts.lastY[p] + (pts.posY[p] - pts.lastY[p]) * alpha,
+						pts.lastZ[p] + (pts.posZ[p] - pts.lastZ[p]) * alpha
+					};
+					write(base + i, pos);
+					centre += pos;
+				}
+				write(base, points > 1 ? centre / static_cast<float>(points - 1) : softbody.derivedPosition);
+			}
+
+			first = std::min(first, base);
+			end = std::max(end, base + count);
+		}
+
+		if (out) {
+			wf::wgl::endVertexStreamWrite(mesh.stream, end ? first : 0, end ? end - first : 0);
+		}
+		else if (end) {
+			wf::wgl::updateMeshData(mesh.buffers, mesh.vertices, mesh.indices);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Engine.h"
+
+#include "Poly/ShapeAsset.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Squishies
+{
+	namespace Component
+	{
+		struct SoftBody;
+	}
+
+	class SoftBodySystem;
+
+	/**
+	 * @brief Draws the soft bodies in batches rather than one at a time.
+	 *
+	 * Bodies whose materials would bind the same (everything but the diffuse colour) share a batch: one entity with one
+	 * mesh holding all of their geometry one after the other, which the render system draws in a single call. Each body's
+	 * colour goes into its vertex colours instead. The bodies keep their own MeshRenderer, for the material, but no mesh.
+	 *
+	 * Positions are written each frame straight into the batch's vertex stream; everything else is only rewritten when a
+	 * batch's bodies change.
+	 */
+	class SoftBodyRenderSystem : public wf::ISystem
+	{
+	public:
+		SoftBodyRenderSystem(wf::Scene* scene, SoftBodySystem* physics);
+
+		virtual bool init() override;
+		virtual void teardown() override;
+		virtual void update(float dt) override;
+
+	private:
+		struct Member
+		{
+			wf::EntityID id;
+			const ShapeAsset* shape;
+			wf::Colour colour;
+
+			bool operator==(const Member& other) const = default;
+		};
+
+		struct Batch
+		{
+			wf::EntityID entity;									// carries the mesh and material the render system draws
+			wf::Material material;									// what the bodies' materials are compared against
+
+			std::vector<Member> members;							// in the order they're laid out in the mesh
+			std::vector<uint32_t> firstVertex;						// per member
+			std::vector<uint8_t> unsettled;							// per member, writes still owed since it last moved
+
+			// gathered this frame
+			std::vector<Member> next;
+			std::vector<const Component::SoftBody*> bodies;
+		};
+
+		/**
+		 * @brief If two materials bind the same, ignoring the diffuse colour
+		 */
+		static bool canShare(const wf::Material& a, const wf::Material& b);
+
+		Batch& findBatch(const wf::Material& material);
+		void layout(Batch& batch);
+		void writePositions(Batch& batch);
+
+	private:
+		SoftBodySystem* m_physics{ nullptr };
+		std::vector<Batch> m_batches;
+	};
+}
@@ -2,16 +2,31 @@
 
 #include "Component/CharacterComponent.h"
 #include "Component/ColliderComponent.h"
+#include "Component/HeightfieldColliderComponent.h"
 #include "Component/SoftBodyComponent.h"
+#include "Component/StaticColliderComponent.h"
 #include "Config.h"
+#include "Event/Explosion.h"
+#include "Utils/JointKernels.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <vector>
 
 namespace Squishies
 {
 	SoftBodySystem::SoftBodySystem(wf::Scene* scene)
-		:ISystem(scene), m_collider(scene->getEventDispatcher())
+		:ISystem(scene), m_collider(scene->getEventDispatcher()), m_grid(Config::get().spatialCellSize),
+		m_staticGrid(Config::get().spatialCellSize)
 	{
+		setThreadCount(Config::get().physicsThreads);
+		setSimulationThread(Config::get().simulationThread);
+	}
+
+	SoftBodySystem::~SoftBodySystem()
+	{
+		setSimulationThread(false);
 	}
 
 	bool SoftBodySystem::init()
@@ -20,61 +35,499 @@ namespace Squishies
 			createSquishy(entity);
 			});
 
+		// anything caught in a blast needs to be awake to feel it
+		eventDispatcher->on<event::Explosion>([&](event::Explosion& e) {
+			wf::BoundingBox blast;
+			blast.extend(e.position - wf::Vec3(e.radius));
+			blast.extend(e.position + wf::Vec3(e.radius));
+
+			m_queryResults.clear();
+			m_grid.query(blast, m_queryResults);
+
+			for (auto id : m_queryResults) {
+				entityManager->get(static_cast<wf::EntityID>(id)).getComponent<Component::SoftBody>().wake();
+			}
+			});
+
+		entityManager->onRemove<Component::SoftBody>([&](wf::Entity entity) {
+			auto& softbody = entity.getComponent<Component::SoftBody>();
+			m_grid.remove(softbody.gridProxy);
+			softbody.gridProxy = wf::SpatialHashGrid::INVALID;
+			});
+
+		entityManager->onCreate<Component::StaticCollider>([&](wf::Entity entity) {
+			createStaticCollider(entity);
+			});
+
+		entityManager->onRemove<Component::StaticCollider>([&](wf::Entity entity) {
+			auto& fixture = entity.getComponent<Component::StaticCollider>();
+			m_staticGrid.remove(fixture.gridProxy);
+			fixture.gridProxy = wf::SpatialHashGrid::INVALID;
+			});
+
+		entityManager->onCreate<Component::HeightfieldCollider>([&](wf::Entity entity) {
+			createHeightfieldCollider(entity);
+			});
+
 		return true;
 	}
 
 	void SoftBodySystem::update(float dt)
 	{
-		entityManager->each<Component::SoftBody, wf::MeshRendererComponent>(
-			[&](wf::EntityID id, Component::SoftBody& softbody, wf::MeshRendererComponent& meshRenderer) {
+		// with a simulation thread, pick up what it last published for the SoftBodyRenderSystem to draw from. without
+		// one, nothing else is touching the bodies and they're read directly
+		if (m_threaded) m_snapshots.acquire();
+	}
+
+	void SoftBodySystem::fixedUpdate(float dt)
+	{
+		// on the simulation thread, the step waits for the next launch
+		if (m_threaded) {
+			m_queuedSteps.push_back(dt);
+			return;
+		}
+
+		step(dt);
+	}
+
+	void SoftBodySystem::step(float dt)
+	{
+		gatherBodies();
+		prepareAndAccumulateForces();
 
-				entityManager->get(id).getComponent<wf::MeshRendererComponent>().material.diffuse.colour = softbody.colour;
+		if (m_integrator == Integrator::XPBD) {
+			solvePositions(dt);
+		}
+		else {
+			integrate(dt);
+			hardConstraints();
+		}
 
-				auto& verts = meshRenderer.mesh->vertices;
-				verts[0].position = softbody.derivedPosition;
+		metaUpdates();
+		handleCollisions();
+		postUpdates(dt);
+		updateSleep();
+	}
 
-				// update our actual mesh verts from our points
-				for (size_t i = 1; i < verts.size(); i++) {
-					if (verts[i].position != softbody.points[i - 1].position) {
-						meshRenderer.mesh->needsUpdate = true;
-						verts[i].position = softbody.points[i - 1].position;
+	void SoftBodySystem::setSimulationThread(bool enabled)
+	{
+		if (enabled && hasCoupledSystems()) return;
+		if (enabled == m_threaded) return;
 
-					}
-					//wf::Debug::filledCircle(verts[i].position, 4.f, wf::WHITE);
+		if (enabled) {
+			// anything left from an earlier run is stale; start from where the bodies are now
+			publishSnapshot();
+
+			m_simStopping = false;
+			m_threaded = true;
+			m_simThread = std::thread(&SoftBodySystem::simulationLoop, this);
+			return;
+		}
+
+		// let anything in flight finish, then stop the thread and catch up on whatever was recorded since
+		{
+			std::unique_lock lock(m_simMutex);
+			m_simDone.wait(lock, [&] { return !m_simBusy; });
+			m_simStopping = true;
+		}
+		m_simWake.notify_one();
+		m_simThread.join();
+		m_threaded = false;
+
+		for (float dt : m_queuedSteps) {
+			step(dt);
+		}
+		m_queuedSteps.clear();
+	}
+
+	void SoftBodySystem::addCoupledSystem()
+	{
+		setSimulationThread(false);
+		m_coupledSystems++;
+	}
+
+	void SoftBodySystem::launchSimulation()
+	{
+		if (!m_threaded || m_queuedSteps.empty()) return;
+
+		// the camera can move while we're stepping, so level of detail works from a copy
+		const wf::CameraComponent* camera = scene->getCurrentCamera();
+		if (camera) m_simCamera = *camera;
+		else m_simCamera.reset();
+
+		{
+			std::lock_guard lock(m_simMutex);
+			std::swap(m_runningSteps, m_queuedSteps);
+			m_simBusy = true;
+		}
+		m_simWake.notify_one();
+	}
+
+	void SoftBodySystem::syncSimulation()
+	{
+		if (m_threaded) {
+			std::unique_lock lock(m_simMutex);
+			m_simDone.wait(lock, [&] { return !m_simBusy; });
+		}
+
+		{
+			std::lock_guard lock(m_commandMutex);
+			std::swap(m_runningCommands, m_commands);
+		}
+
+		for (auto& command : m_runningCommands) {
+			command();
+		}
+		m_runningCommands.clear();
+	}
+
+	void SoftBodySystem::post(std::function<void()> command)
+	{
+		if (!m_threaded) {
+			command();
+			return;
+		}
+
+		std::lock_guard lock(m_commandMutex);
+		m_commands.push_back(std::move(command));
+	}
+
+	void SoftBodySystem::simulationLoop()
+	{
+		std::unique_lock lock(m_simMutex);
+
+		while (true) {
+			m_simWake.wait(lock, [&] { return m_simBusy || m_simStopping; });
+			if (m_simStopping) return;
+
+			lock.unlock();
+
+			for (float dt : m_runningSteps) {
+				step(dt);
+			}
+			m_runningSteps.clear();
+
+			publishSnapshot();
+
+			lock.lock();
+			m_simBusy = false;
+			m_simDone.notify_all();
+		}
+	}
+
+	void SoftBodySystem::publishSnapshot()
+	{
+		Snapshot& snapshot = m_snapshots.getWriteBuffer();
+		snapshot.bodies.clear();
+		snapshot.posX.clear();
+		snapshot.posY.clear();
+		snapshot.posZ.clear();
+		snapshot.lastX.clear();
+		snapshot.lastY.clear();
+		snapshot.lastZ.clear();
+
+		entityManager->each<Component::SoftBody>(
+			[&](wf::EntityID id, const Component::SoftBody& softbody) {
+				const auto& pts = softbody.points;
+
+				BodyState& state = snapshot.bodies.emplace_back();
+				state.id = id;
+				state.derivedPosition = softbody.derivedPosition;
+				state.derivedRotation = softbody.derivedRotation;
+				state.derivedVelocity = softbody.derivedVelocity;
+				state.boundingBox = softbody.boundingBox;
+				state.sleeping = softbody.sleeping;
+				state.stepped = !softbody.sleeping && softbody.lodSteps == 0;
+				state.firstPoint = static_cast<uint32_t>(snapshot.posX.size());
+				state.pointCount = static_cast<uint32_t>(pts.size());
+
+				snapshot.posX.insert(snapshot.posX.end(), pts.posX.begin(), pts.posX.begin() + pts.size());
+				snapshot.posY.insert(snapshot.posY.end(), pts.posY.begin(), pts.posY.begin() + pts.size());
+				snapshot.posZ.insert(snapshot.posZ.end(), pts.posZ.begin(), pts.posZ.begin() + pts.size());
+				snapshot.lastX.insert(snapshot.lastX.end(), pts.lastX.begin(), pts.lastX.begin() + pts.size());
+				snapshot.lastY.insert(snapshot.lastY.end(), pts.lastY.begin(), pts.lastY.begin() + pts.size());
+				snapshot.lastZ.insert(snapshot.lastZ.end(), pts.lastZ.begin(), pts.lastZ.begin() + pts.size());
+
+				// the derived position is the mean of the points, so the same goes for where it was
+				wf::Vec3 last{};
+				for (size_t i = 0; i < pts.size(); i++) {
+					last += pts.getLastPosition(i);
 				}
+				state.lastPosition = pts.size() ? last / static_cast<float>(pts.size()) : softbody.derivedPosition;
 			});
+
+		std::sort(snapshot.bodies.begin(), snapshot.bodies.end(), [](const BodyState& a, const BodyState& b) { return a.id < b.id; });
+
+		m_snapshots.publish();
 	}
 
-	void SoftBodySystem::fixedUpdate(float dt)
+	const SoftBodySystem::BodyState* SoftBodySystem::Snapshot::find(wf::EntityID id) const
 	{
-		prepareAndAccumulateForces();
-		integrate(dt);
-		hardConstraints();
-		metaUpdates();
-		handleCollisions();
-		postUpdates();
+		auto it = std::lower_bound(bodies.begin(), bodies.end(), id, [](const BodyState& state, wf::EntityID id) { return state.id < id; });
+		return it != bodies.end() && it->id == id ? &*it : nullptr;
+	}
+
+	void SoftBodySystem::setThreadCount(size_t count)
+	{
+		m_threadPool = std::make_unique<wf::ThreadPool>(count);
+	}
+
+	void SoftBodySystem::setIntegrator(Integrator integrator, uint32_t substeps, bool adaptive)
+	{
+		m_integrator = integrator;
+		m_substeps = std::max(substeps, 1u);
+		m_adaptive = adaptive;
+	}
+
+	// QUERIES: the grid narrows things down to the bodies nearby, then each is tested against its bounding box and, where
+	// it matters, its outline through the edge tree
+	void SoftBodySystem::queryRegion(const wf::BoundingBox& region, std::vector<wf::EntityID>& out, const QueryFilter& filter)
+	{
+		gatherQueryBodies(wf::Vec2(region.min), wf::Vec2(region.max), filter);
+
+		for (const auto& [id, softbody] : m_queryBodies) {
+			out.push_back(id);
+		}
+	}
+
+	void SoftBodySystem::queryRadius(const wf::Vec3& centre, float radius, std::vector<wf::EntityID>& out, const QueryFilter& filter)
+	{
+		const wf::Vec2 pt(centre);
+		const float radiusSq = radius * radius;
+
+		gatherQueryBodies(pt - wf::Vec2(radius), pt + wf::Vec2(radius), filter);
+
+		for (const auto& [id, softbody] : m_queryBodies) {
+			// a box whose nearest corner is out of reach can't have anything in reach
+			const auto& box = softbody->boundingBox;
+			const wf::Vec2 toBox = pt - glm::clamp(pt, wf::Vec2(box.min), wf::Vec2(box.max));
+			if (glm::dot(toBox, toBox) > radiusSq) continue;
+
+			if (softbody->edgeTree.containsPoint(pt, softbody->edges) || closestEdge(*softbody, pt, radiusSq).found()) {
+				out.push_back(id);
+			}
+		}
+	}
+
+	bool SoftBodySystem::raycast(const wf::Ray& ray, float maxDistance, QueryHit& hit, const QueryFilter& filter)
+	{
+		wf::Vec2 dir(ray.direction);
+		const float dirLength = glm::length(dir);
+		if (dirLength < 1e-6f || maxDistance <= 0.f) return false;
+
+		const wf::Vec2 from(ray.origin);
+		const wf::Vec2 path = dir * (maxDistance / dirLength);
+		const wf::Vec2 to = from + path;
+
+		gatherRayBodies(from, to, filter);
+
+		// where the ray enters each box, as a fraction of the way along it
+		m_queryOrder.clear();
+		for (uint32_t i = 0; i < m_queryBodies.size(); i++) {
+			const auto& box = m_queryBodies[i].second->boundingBox;
+
+			float enter = 0.f;
+			float leave = 1.f;
+			for (int axis = 0; axis < 2; axis++) {
+				if (std::abs(path[axis]) < 1e-12f) {
+					if (from[axis] < box.min[axis] || from[axis] > box.max[axis]) leave = -1.f;
+					continue;
+				}
+
+				float t1 = (box.min[axis] - from[axis]) / path[axis];
+				float t2 = (box.max[axis] - from[axis]) / path[axis];
+				if (t1 > t2) std::swap(t1, t2);
+
+				enter = std::max(enter, t1);
+				leave = std::min(leave, t2);
+			}
+
+			if (enter <= leave) m_queryOrder.push_back({ enter, i });
+		}
+
+		// nearest box first, so once something's hit, nothing whose box starts beyond it needs looking at
+		std::sort(m_queryOrder.begin(), m_queryOrder.end());
+
+		float hitT = 1.f;
+		size_t hitBody = SIZE_MAX;
+		size_t hitEdge = SIZE_MAX;
+
+		for (const auto& [enter, i] : m_queryOrder) {
+			if (enter > hitT) break;
+
+			const auto& softbody = *m_queryBodies[i].second;
+			size_t edge = Collider::firstCrossing(softbody.edges, softbody.edgeTree, from, to, hitT);
+			if (edge != SIZE_MAX) {
+				hitBody = i;
+				hitEdge = edge;
+			}
+		}
+
+		if (hitBody == SIZE_MAX) return false;
+
+		hit.entity = m_queryBodies[hitBody].first;
+		hit.point = wf::Vec3(from + path * hitT, 0.f);
+		hit.normal = m_queryBodies[hitBody].second->edges.getNormal(hitEdge);
+		hit.distance = hitT * maxDistance;
+		hit.edge = hitEdge;
+		return true;
+	}
+
+	bool SoftBodySystem::nearest(const wf::Vec3& point, float maxDistance, QueryHit& hit, const QueryFilter& filter)
+	{
+		const wf::Vec2 pt(point);
+		gatherQueryBodies(pt - wf::Vec2(maxDistance), pt + wf::Vec2(maxDistance), filter);
+
+		float bestSq = maxDistance * maxDistance;
+		bool found = false;
+
+		for (const auto& [id, softbody] : m_queryBodies) {
+			// nothing on the body is nearer than its box, and nothing beats being inside
+			const auto& box = softbody->boundingBox;
+			const wf::Vec2 toBox = pt - glm::clamp(pt, wf::Vec2(box.min), wf::Vec2(box.max));
+			if (glm::dot(toBox, toBox) > bestSq || (found && hit.distance == 0.f)) continue;
+
+			const bool inside = softbody->edgeTree.containsPoint(pt, softbody->edges);
+			EdgeKernels::Closest edge = closestEdge(*softbody, pt, inside ? FLT_MAX : bestSq);
+			if (!edge.found()) continue;
+
+			bestSq = inside ? 0.f : edge.distSq;
+			found = true;
+
+			hit.entity = id;
+			hit.point = wf::Vec3(edge.hitPoint, 0.f);
+			hit.normal = softbody->edges.getNormal(edge.edge);
+			hit.distance = inside ? 0.f : std::sqrt(edge.distSq);
+			hit.edge = edge.edge;
+		}
+
+		return found;
+	}
+
+	void SoftBodySystem::gatherQueryBodies(const wf::Vec2& min, const wf::Vec2& max, const QueryFilter& filter)
+	{
+		// the bodies are all in the plane, and the grid has them there
+		wf::BoundingBox region;
+		region.extend(wf::Vec3(min, 0.f));
+		region.extend(wf::Vec3(max, 0.f));
+
+		m_queryResults.clear();
+		m_grid.query(region, m_queryResults);
+
+		filterQueryBodies(min, max, filter);
+	}
+
+	void SoftBodySystem::gatherRayBodies(const wf::Vec2& from, const wf::Vec2& to, const QueryFilter& filter)
+	{
+		// only the cells the ray passes through; a long diagonal one would cover a lot of empty box
+		m_queryResults.clear();
+		m_grid.queryRay(wf::Vec3(from, 0.f), wf::Vec3(to, 0.f), m_queryResults);
+
+		filterQueryBodies(glm::min(from, to), glm::max(from, to), filter);
+	}
+
+	void SoftBodySystem::filterQueryBodies(const wf::Vec2& min, const wf::Vec2& max, const QueryFilter& filter)
+	{
+		m_queryBodies.clear();
+		for (auto handle : m_queryResults) {
+			auto entity = entityManager->get(static_cast<wf::EntityID>(handle));
+			if (!entity.isValid()) continue;
+
+			int collisionGroup = CollisionGroup::DEFAULT;
+			int collisionMask = CollisionGroup::ALL;
+			if (entity.hasComponent<Component::Collider>()) {
+				const auto& collider = entity.getComponent<Component::Collider>();
+				collisionGroup = collider.collisionGroup;
+				collisionMask = collider.collisionMask;
+			}
+			if (!filter.accepts(collisionGroup, collisionMask)) continue;
+
+			// sharing a cell is only a maybe
+			const auto& softbody = entity.getComponent<Component::SoftBody>();
+			const auto& box = softbody.boundingBox;
+			if (!box.isValid || box.max.x < min.x || box.min.x > max.x || box.max.y < min.y || box.min.y > max.y) continue;
+
+			m_queryBodies.push_back({ entity.handle, &softbody });
+		}
+	}
+
+	EdgeKernels::Closest SoftBodySystem::closestEdge(const Component::SoftBody& softbody, const wf::Vec2& pt, float maxDistSq)
+	{
+		// with no normal to go on, every edge counts as facing away, so they all compete for the one result
+		EdgeKernels::Closest closest;
+		EdgeKernels::Closest unused;
+		closest.distSq = maxDistSq;
+
+		softbody.edgeTree.nearest(pt,
+			[&](uint32_t first, uint32_t count) {
+				EdgeKernels::findClosest(softbody.edges, first, count, pt, wf::Vec2{}, closest, unused);
+			},
+			[&]() { return closest.distSq; });
+
+		return closest;
+	}
+
+	void SoftBodySystem::gatherBodies()
+	{
+		m_stepCount++;
+
+		// at low detail a body only takes part every lodInterval steps, catching up on the time it missed. that's only
+		// safe when the integrator stays stable over the longer step. in between it's held still like a sleeping body, so
+		// nothing moves it while its edges, box and grid cell aren't being kept up to date
+		const auto& config = Config::get();
+		const wf::CameraComponent* camera = m_threaded ? (m_simCamera ? &*m_simCamera : nullptr) : scene->getCurrentCamera();
+		const bool lod = config.lod && config.lodInterval > 1 && camera && m_integrator == Integrator::XPBD;
+
+		// fixed bodies don't take part in any of the per-body phases, and sleeping ones sit them out until woken
+		m_bodies.clear();
+		m_simBodies.clear();
+		entityManager->each<Component::SoftBody>(
+			[&](wf::EntityID id, Component::SoftBody& softbody) {
+				if (softbody.fixed) return;
+
+				softbody.solverIndex = static_cast<uint32_t>(m_simBodies.size());
+				m_simBodies.push_back(&softbody);
+
+				softbody.lodSkipped = false;
+				if (softbody.sleeping) return;
+
+				softbody.lodSteps++;
+
+				// off-screen or far from the camera; staggered by entity so they don't all come due on the same step.
+				// anything that's just been woken or pushed gets the full step
+				if (lod && softbody.lodSteps < config.lodInterval && !softbody.fullDetail) {
+					wf::Vec3 toCamera = camera->position - softbody.derivedPosition;
+					bool distant = glm::dot(toCamera, toCamera) > config.lodDistance * config.lodDistance;
+
+					if ((distant || !camera->canSee(softbody.boundingBox)) && (m_stepCount + static_cast<uint32_t>(id)) % config.lodInterval) {
+						softbody.lodSkipped = true;
+						return;
+					}
+				}
+
+				softbody.fullDetail = false;
+				m_bodies.push_back(&softbody);
+			});
+
+		m_heightfields.clear();
+		entityManager->each<Component::HeightfieldCollider>(
+			[&](wf::EntityID id, Component::HeightfieldCollider& ground) {
+				if (ground.field.isValid()) m_heightfields.push_back(&ground.field);
+			});
 	}
 
 	// 0. BUILD
 	//		1. foreach point, keep an original, update the global shape and reset transforms
-	//		2. point the mesh
-	//		3. build the joints
+	//		(the joints come already packed with the shape, and the body is drawn from the shape's mesh in a batch)
 	void SoftBodySystem::createSquishy(wf::Entity entity)
 	{
 		// grab the body we'll be building from
 		auto& softbody = entity.getComponent<Component::SoftBody>();
-
-		// create the dynamic geometry
-		auto& points = softbody.shape.getPoints();
-		auto& meshRenderer = entity.getComponent<wf::MeshRendererComponent>();
-		meshRenderer.mesh = softbody.shape.createMesh();
-		meshRenderer.mesh->isDynamic = true;
-		meshRenderer.material.diffuse.colour = softbody.colour;
+		auto& points = softbody.shape->squishy.getPoints();
 
 		// set up the pointmasses for all of the vertices.
 		// we can probably use the indices too for joints, though might be a little sloppy
 		auto& transform = entity.getComponent<wf::TransformComponent>();
-		auto& mesh = meshRenderer.mesh;
 
 		softbody.points.resize(points.size());
 
@@ -88,88 +541,100 @@ namespace Squishies
 		// gather up the original points and the derived global shape
 		for (size_t i = 0; i < points.size(); i++) {
 			// get our point position in worldspace
-			auto newPos = wf::Vec3(softbody.shape.getPoint(i), 0.f) + softbody.derivedPosition;
+			auto newPos = wf::Vec3(softbody.shape->squishy.getPoint(i), 0.f) + softbody.derivedPosition;
 
 			// store it in position and globalPosition
-			softbody.points[i].position = newPos;
-			softbody.points[i].globalPosition = newPos;
+			softbody.points.setPosition(i, newPos);
+			softbody.points.setLastPosition(i, newPos);
+			softbody.points.setGlobalPosition(i, newPos);
 		}
 
 		softbody.updateAll();
+
+		// and register in the grid
+		softbody.gridProxy = m_grid.insert(softbody.boundingBox, static_cast<uint32_t>(entity.handle));
+	}
+
+	// 0b. BUILD STATIC: place the geometry in the world once, give it a mesh if it wants one, and register it
+	void SoftBodySystem::createStaticCollider(wf::Entity entity)
+	{
+		auto& fixture = entity.getComponent<Component::StaticCollider>();
+		auto& transform = entity.getComponent<wf::TransformComponent>();
+
+		fixture.build(transform);
+
+		// unlike soft bodies the mesh stays relative to the transform, which never changes
+		if (fixture.closed && entity.hasComponent<wf::MeshRendererComponent>()) {
+			auto& meshRenderer = entity.getComponent<wf::MeshRendererComponent>();
+			if (!meshRenderer.mesh) {
+				meshRenderer.mesh = Squishy(fixture.shape).createMesh();
+			}
+		}
+
+		fixture.gridProxy = m_staticGrid.insert(fixture.boundingBox, static_cast<uint32_t>(entity.handle));
+	}
+
+	// 0c. BUILD GROUND: unless we've been given heights already, take them from the terrain mesh where it's been placed
+	void SoftBodySystem::createHeightfieldCollider(wf::Entity entity)
+	{
+		auto& ground = entity.getComponent<Component::HeightfieldCollider>();
+		if (ground.field.isValid() || !entity.hasComponent<wf::MeshRendererComponent>()) return;
+
+		const auto& meshRenderer = entity.getComponent<wf::MeshRendererComponent>();
+		if (!meshRenderer.mesh) return;
+
+		wf::Vec3 offset{};
+		if (entity.hasComponent<wf::TransformComponent>()) {
+			offset = entity.getComponent<wf::TransformComponent>().position;
+		}
+
+		ground.field = wf::Heightfield::fromMesh(*meshRenderer.mesh, offset);
 	}
 
 	// 1. PREP: foreach body
 	//		1. update shape meta for shape matching
 	//		2. accumulate external forces - gravity, etc
-	//		3. accumulate internal forces - spring joints, etc
+	//		3. accumulate internal forces - spring joints, etc (not for XPBD, which solves them as constraints)
 	//
 	// @todo check shape meta stuff for 3D
 	void SoftBodySystem::prepareAndAccumulateForces()
 	{
-		entityManager->each<Component::SoftBody>(
+		forEachBody(
 			[&](Component::SoftBody& softbody) {
 
-				if (softbody.fixed) return;
-
 				// update details about perceived position/rotation/velocity of the overall body
 				softbody.updateDerivedData();
 				softbody.updateGlobalShape();
 
+				auto& pts = softbody.points;
+
+				// forces from outside have been piling up over every step we sat out, and are about to be integrated over
+				// all of them at once; take the average so the impulse comes out the same as at full detail
+				if (softbody.lodSteps > 1) {
+					const float average = 1.f / softbody.lodSteps;
+					for (size_t i = 0; i < pts.size(); i++) {
+						pts.forceX[i] *= average;
+						pts.forceY[i] *= average;
+						pts.forceZ[i] *= average;
+					}
+				}
+
 				// apply gravity
-				for (auto& pt : softbody.points) {
-					if (pt.fixed) continue;
-					pt.force += wf::Vec3(0.f, Config::get().gravity, 0.f) * pt.mass;
+				const float gravity = Config::get().gravity;
+				for (size_t i = 0; i < pts.size(); i++) {
+					if (pts.isFixed(i)) continue;
+					pts.forceY[i] += gravity * pts.mass[i];
 				}
 
+				if (m_integrator != Integrator::FORCES) return;
+
 				// internal forces - springs, shape matching, etc.
-				// first the joints
-				for (auto& [p1, p2, rest] : softbody.shape.getJoints()) {
-					if (softbody.points[p1].fixed && softbody.points[p2].fixed) {
-						continue;
-					}
-					wf::Vec3 force = wf::getSpringForce(
-						softbody.points[p1].position,
-						softbody.points[p1].velocity,
-						softbody.points[p2].position,
-						softbody.points[p2].velocity,
-						softbody.jointK,
-						softbody.jointDamping,
-						rest
-					);
-
-					if (!softbody.points[p1].fixed) softbody.points[p1].force += force;
-					if (!softbody.points[p2].fixed) softbody.points[p2].force -= force;
-				}
+				// first the joints, a conflict-free batch at a time
+				JointKernels::accumulateJoints(softbody.shape->joints, pts, softbody.jointK, softbody.jointDamping);
 
+				// then springs to the global shape; kinematic bodies hold their points to it, so it doesn't move with them
 				if (softbody.shapeMatching) {
-					for (size_t i = 0; i < softbody.points.size(); i++) {
-						wf::Vec3 shapeMatchForce{};
-
-						if (!softbody.kinematic) {
-							shapeMatchForce = wf::getSpringForce(
-								softbody.points[i].position,
-								softbody.points[i].velocity,
-								softbody.points[i].globalPosition,
-								softbody.points[i].velocity,
-								softbody.shapeMatchK,
-								softbody.shapeMatchDamping,
-								0.f
-							);
-						}
-						else {
-							shapeMatchForce = wf::getSpringForce(
-								softbody.points[i].position,
-								softbody.points[i].velocity,
-								softbody.points[i].globalPosition,
-								wf::Vec3{},
-								softbody.shapeMatchK,
-								softbody.shapeMatchDamping,
-								0.f
-							);
-						}
-
-						softbody.points[i].force += shapeMatchForce;
-					}
+					JointKernels::accumulateShapeMatch(pts, softbody.shapeMatchK, softbody.shapeMatchDamping, softbody.kinematic);
 				}
 			});
 	}
@@ -181,21 +646,44 @@ namespace Squishies
 	//		4. force = { 0.f };
 	void SoftBodySystem::integrate(float dt)
 	{
-		entityManager->each<Component::SoftBody>(
+		forEachBody(
 			[&](Component::SoftBody& softbody) {
 
-				if (softbody.fixed) return;
+				auto& pts = softbody.points;
+				const float bodyDt = dt * softbody.lodSteps;
+
+				// straight runs over the padded arrays so the compiler can vectorise; padding has no inverse mass so stays put.
+				const size_t count = pts.paddedSize();
+
+				float* __restrict px = pts.posX.data();
+				float* __restrict py = pts.posY.data();
+				float* __restrict pz = pts.posZ.data();
+				float* __restrict vx = pts.velX.data();
+				float* __restrict vy = pts.velY.data();
+				float* __restrict vz = pts.velZ.data();
+				float* __restrict lx = pts.lastX.data();
+				float* __restrict ly = pts.lastY.data();
+				float* __restrict lz = pts.lastZ.data();
+				const float* __restrict fx = pts.forceX.data();
+				const float* __restrict fy = pts.forceY.data();
+				const float* __restrict fz = pts.forceZ.data();
+				const float* __restrict im = pts.invMass.data();
 
-				for (size_t i = 0; i < softbody.points.size(); i++) {
-					// avoid pointless division by doing pointless code.
-					auto fm = softbody.points[i].mass > 1.f ? (softbody.points[i].force / softbody.points[i].mass) : softbody.points[i].force;
-					softbody.points[i].velocity += fm * dt;
+				for (size_t i = 0; i < count; i++) {
+					vx[i] += fx[i] * im[i] * bodyDt;
+					vy[i] += fy[i] * im[i] * bodyDt;
+					vz[i] += fz[i] * im[i] * bodyDt;
 
-					softbody.points[i].lastPosition = softbody.points[i].position;
-					softbody.points[i].position += softbody.points[i].velocity * dt;
+					lx[i] = px[i];
+					ly[i] = py[i];
+					lz[i] = pz[i];
 
-					softbody.points[i].force = {};
+					px[i] += vx[i] * bodyDt;
+					py[i] += vy[i] * bodyDt;
+					pz[i] += vz[i] * bodyDt;
 				}
+
+				pts.clearForces();
 			});
 	}
 
@@ -206,12 +694,10 @@ namespace Squishies
 	//			float dampingZ = 0.9f;
 	void SoftBodySystem::hardConstraints()
 	{
-		entityManager->each<Component::SoftBody>(
+		forEachBody(
 			[&](Component::SoftBody& softbody) {
 
-				if (softbody.fixed) return;
-
-				auto worldBounds = Config::get().worldBounds;
+				auto worldBounds = getWorldBounds();
 
 				if (!worldBounds.isValid) return;
 
@@ -221,64 +707,263 @@ namespace Squishies
 
 				for (size_t i = 0; i < pms.size(); i++) {
 					// horizontals
-					if (pms[i].position.x < worldBounds.min.x) {
-						pms[i].position.x = worldBounds.min.x;
-						pms[i].velocity.x = -pms[i].velocity.x * damping.x;
+					if (pms.posX[i] < worldBounds.min.x) {
+						pms.posX[i] = worldBounds.min.x;
+						pms.velX[i] = -pms.velX[i] * damping.x;
 					}
-					else if (pms[i].position.x > worldBounds.max.x) {
-						pms[i].position.x = worldBounds.max.x;
-						pms[i].velocity.x = -pms[i].velocity.x * damping.x;
+					else if (pms.posX[i] > worldBounds.max.x) {
+						pms.posX[i] = worldBounds.max.x;
+						pms.velX[i] = -pms.velX[i] * damping.x;
 					}
 
-					if (pms[i].position.z < worldBounds.min.z) {
-						pms[i].position.z = worldBounds.min.z;
-						pms[i].velocity.z = -pms[i].velocity.z * damping.x;
+					if (pms.posZ[i] < worldBounds.min.z) {
+						pms.posZ[i] = worldBounds.min.z;
+						pms.velZ[i] = -pms.velZ[i] * damping.x;
 					}
-					else if (pms[i].position.z > worldBounds.max.z) {
-						pms[i].position.z = worldBounds.max.z;
-						pms[i].velocity.z = -pms[i].velocity.z * damping.x;
+					else if (pms.posZ[i] > worldBounds.max.z) {
+						pms.posZ[i] = worldBounds.max.z;
+						pms.velZ[i] = -pms.velZ[i] * damping.x;
 					}
 
 					// vertical
-					if (pms[i].position.y < worldBounds.min.y) {
-						pms[i].position.y = worldBounds.min.y;
-						pms[i].velocity.y = -pms[i].velocity.y * damping.y;
-						pms[i].velocity.x *= damping.x;
-						pms[i].velocity.z *= damping.z;
+					if (pms.posY[i] < worldBounds.min.y) {
+						pms.posY[i] = worldBounds.min.y;
+						pms.velY[i] = -pms.velY[i] * damping.y;
+						pms.velX[i] *= damping.x;
+						pms.velZ[i] *= damping.z;
+					}
+					else if (pms.posY[i] > worldBounds.max.y) {
+						pms.posY[i] = worldBounds.max.y;
+						pms.velY[i] = -pms.velY[i] * damping.y;
+						pms.velX[i] *= damping.x;
+						pms.velZ[i] *= damping.z;
 					}
-					else if (pms[i].position.y > worldBounds.max.y) {
-						pms[i].position.y = worldBounds.max.y;
-						pms[i].velocity.y = -pms[i].velocity.y * damping.y;
-						pms[i].velocity.x *= damping.x;
-						pms[i].velocity.z *= damping.z;
+				}
+			});
+	}
+
+	// 2b. XPBD: foreach body, split the step into substeps, and for each
+	//		1. velocity += (force / mass) * h; lastPosition = position; position += velocity * h
+	//		2. project joints, shape matching and the world bounds as compliant position constraints
+	//		3. velocity = (position - lastPosition) / h, bouncing off anything the bounds stopped
+	//
+	// one constraint iteration per substep, so the accumulated lambdas always start at zero and drop out. lastPosition
+	// is put back to where the step started afterwards, same as the force integrator leaves it, for swept collisions.
+	void SoftBodySystem::solvePositions(float dt)
+	{
+		const auto& config = Config::get();
+		const auto worldBounds = getWorldBounds();
+		const wf::Vec3 damping = { .9f, .8f, .9f };
+
+		forEachBody(
+			[&](Component::SoftBody& softbody) {
+
+				// bodies don't interact during the substeps, so each can take as many as it needs
+				const float bodyDt = dt * softbody.lodSteps;
+				const uint32_t substeps = m_adaptive ? chooseSubsteps(softbody, bodyDt) : m_substeps;
+				const float h = bodyDt / substeps;
+
+				// hitting the bounds slower than gravity manages in a couple of substeps just stops, rather than jittering
+				const float restSpeed = 2.f * std::abs(config.gravity) * h;
+
+				// sliding along the floor is touched every substep rather than once a step, so spread that damping out
+				const float perStep = 1.f / substeps;
+				const wf::Vec3 slide = { std::pow(damping.x, perStep), std::pow(damping.y, perStep), std::pow(damping.z, perStep) };
+
+				auto& pts = softbody.points;
+				const auto& joints = softbody.shape->joints;
+				const size_t count = pts.paddedSize();
+
+				float* __restrict px = pts.posX.data();
+				float* __restrict py = pts.posY.data();
+				float* __restrict pz = pts.posZ.data();
+				float* __restrict vx = pts.velX.data();
+				float* __restrict vy = pts.velY.data();
+				float* __restrict vz = pts.velZ.data();
+				float* __restrict lx = pts.lastX.data();
+				float* __restrict ly = pts.lastY.data();
+				float* __restrict lz = pts.lastZ.data();
+				const float* __restrict fx = pts.forceX.data();
+				const float* __restrict fy = pts.forceY.data();
+				const float* __restrict fz = pts.forceZ.data();
+				const float* __restrict im = pts.invMass.data();
+
+				auto weight = [&](size_t i) { return pts.isFixed(i) ? 0.f : im[i]; };
+
+				// where the step started, for lastPosition once the substeps are done
+				thread_local std::vector<float> startX, startY, startZ;
+				startX.assign(px, px + count);
+				startY.assign(py, py + count);
+				startZ.assign(pz, pz + count);
+
+				// compliance is 1/k scaled by 1/h^2; damping folds in as gamma = damping / (k * h)
+				const float jointAlpha = 1.f / (softbody.jointK * h * h);
+				const float jointGamma = softbody.jointDamping / (softbody.jointK * h);
+				const float shapeAlpha = 1.f / (softbody.shapeMatchK * h * h);
+
+				// the force version only damps shape matching for kinematic bodies, where the target is still
+				const float shapeGamma = softbody.kinematic ? softbody.shapeMatchDamping / (softbody.shapeMatchK * h) : 0.f;
+
+				for (uint32_t step = 0; step < substeps; step++) {
+					// predict
+					for (size_t i = 0; i < count; i++) {
+						vx[i] += fx[i] * im[i] * h;
+						vy[i] += fy[i] * im[i] * h;
+						vz[i] += fz[i] * im[i] * h;
+
+						lx[i] = px[i];
+						ly[i] = py[i];
+						lz[i] = pz[i];
+
+						px[i] += vx[i] * h;
+						py[i] += vy[i] * h;
+						pz[i] += vz[i] * h;
+					}
+
+					// joints: C = |p1 - p2| - rest, in packed order
+					for (size_t j = 0; j < joints.size(); j++) {
+						const uint32_t p1 = joints.p1[j];
+						const uint32_t p2 = joints.p2[j];
+						const float rest = joints.rest[j];
+
+						const float w1 = weight(p1);
+						const float w2 = weight(p2);
+						if (w1 + w2 == 0.f) continue;
+
+						wf::Vec3 d = { px[p1] - px[p2], py[p1] - py[p2], pz[p1] - pz[p2] };
+						float dist = glm::length(d);
+						if (dist < .01f) continue;
+
+						wf::Vec3 n = d / dist;
+						wf::Vec3 moved = wf::Vec3{ px[p1] - lx[p1], py[p1] - ly[p1], pz[p1] - lz[p1] }
+							- wf::Vec3{ px[p2] - lx[p2], py[p2] - ly[p2], pz[p2] - lz[p2] };
+
+						float lambda = (rest - dist - jointGamma * glm::dot(n, moved)) / ((1.f + jointGamma) * (w1 + w2) + jointAlpha);
+
+						wf::Vec3 c1 = n * (lambda * w1);
+						wf::Vec3 c2 = n * (lambda * w2);
+						px[p1] += c1.x; py[p1] += c1.y; pz[p1] += c1.z;
+						px[p2] -= c2.x; py[p2] -= c2.y; pz[p2] -= c2.z;
+					}
+
+					// shape matching: C = |p - global|, the global shape being immovable
+					if (softbody.shapeMatching) {
+						for (size_t i = 0; i < pts.size(); i++) {
+							const float w = weight(i);
+							if (w == 0.f) continue;
+
+							wf::Vec3 d = wf::Vec3{ px[i], py[i], pz[i] } - pts.getGlobalPosition(i);
+							float dist = glm::length(d);
+							if (dist < .01f) continue;
+
+							wf::Vec3 n = d / dist;
+							wf::Vec3 moved = { px[i] - lx[i], py[i] - ly[i], pz[i] - lz[i] };
+
+							float lambda = (-dist - shapeGamma * glm::dot(n, moved)) / ((1.f + shapeGamma) * w + shapeAlpha);
+
+							wf::Vec3 c = n * (lambda * w);
+							px[i] += c.x; py[i] += c.y; pz[i] += c.z;
+						}
+					}
+
+					// world bounds, with no compliance at all
+					if (worldBounds.isValid) {
+						for (size_t i = 0; i < pts.size(); i++) {
+							px[i] = std::clamp(px[i], worldBounds.min.x, worldBounds.max.x);
+							py[i] = std::clamp(py[i], worldBounds.min.y, worldBounds.max.y);
+							pz[i] = std::clamp(pz[i], worldBounds.min.z, worldBounds.max.z);
+						}
+					}
+
+					// velocities from what actually happened; vx etc. still hold the velocity from before the solve
+					for (size_t i = 0; i < pts.size(); i++) {
+						wf::Vec3 v = { (px[i] - lx[i]) / h, (py[i] - ly[i]) / h, (pz[i] - lz[i]) / h };
+
+						if (worldBounds.isValid) {
+							auto bounce = [&](float before) { return std::abs(before) < restSpeed ? 0.f : -before; };
+
+							if ((px[i] <= worldBounds.min.x && vx[i] < 0.f) || (px[i] >= worldBounds.max.x && vx[i] > 0.f)) {
+								v.x = bounce(vx[i]) * damping.x;
+							}
+
+							if ((pz[i] <= worldBounds.min.z && vz[i] < 0.f) || (pz[i] >= worldBounds.max.z && vz[i] > 0.f)) {
+								v.z = bounce(vz[i]) * damping.x;
+							}
+
+							if ((py[i] <= worldBounds.min.y && vy[i] < 0.f) || (py[i] >= worldBounds.max.y && vy[i] > 0.f)) {
+								v.y = bounce(vy[i]) * damping.y;
+								v.x *= slide.x;
+								v.z *= slide.z;
+							}
+						}
+
+						vx[i] = v.x;
+						vy[i] = v.y;
+						vz[i] = v.z;
 					}
 				}
+
+				std::copy(startX.begin(), startX.end(), lx);
+				std::copy(startY.begin(), startY.end(), ly);
+				std::copy(startZ.begin(), startZ.end(), lz);
+
+				pts.clearForces();
 			});
 	}
 
+	uint32_t SoftBodySystem::chooseSubsteps(const Component::SoftBody& softbody, float dt) const
+	{
+		const auto& pts = softbody.points;
+
+		// CFL-style: no point should cover more than half of the shortest edge in a substep, and a substep should be
+		// short next to the period of the stiffest spring (omega * h <= 1)
+		float maxSpeedSq = 0.f;
+		float maxInvMass = 0.f;
+		for (size_t i = 0; i < pts.size(); i++) {
+			maxSpeedSq = std::max(maxSpeedSq, pts.velX[i] * pts.velX[i] + pts.velY[i] * pts.velY[i] + pts.velZ[i] * pts.velZ[i]);
+			if (!pts.isFixed(i)) maxInvMass = std::max(maxInvMass, pts.invMass[i]);
+		}
+
+		float minEdge = FLT_MAX;
+		for (size_t i = 0; i < softbody.edges.size(); i++) {
+			if (softbody.edges.length[i] > 0.f) minEdge = std::min(minEdge, softbody.edges.length[i]);
+		}
+
+		float stiffness = std::max(softbody.jointK, softbody.shapeMatching ? softbody.shapeMatchK : 0.f);
+		float omega = std::sqrt(stiffness * maxInvMass);
+
+		float travel = minEdge < FLT_MAX ? std::sqrt(maxSpeedSq) * dt / (.5f * minEdge) : 0.f;
+		float needed = std::ceil(std::max(travel, omega * dt));
+
+		return static_cast<uint32_t>(std::clamp(needed, 1.f, static_cast<float>(m_substeps)));
+	}
+
 	// 4. META UPDATES: foreach body
 	//		1. update bounding box
 	//		2. update edge data
-	//		3. update bitmask (where in the world on the "grid" for collisions)
+	//		3. move our registration in the spatial grid
 	void SoftBodySystem::metaUpdates()
 	{
-		entityManager->each<Component::SoftBody>(
+		forEachBody(
 			[&](Component::SoftBody& softbody) {
 
-				if (softbody.fixed) return;
-
 				softbody.updateAll();
 
 				// clear our point details ready for collision detection
-				for (auto& pt : softbody.points) {
-					pt.insideAnother = false;
-				}
+				softbody.points.clearInsideAnother();
 			});
+
+		// the grid is shared, so this part is one at a time
+		for (auto* softbody : m_bodies) {
+			m_grid.move(softbody->gridProxy, softbody->boundingBox);
+		}
 	}
 
-	// 5. COLLISIONS: for each body and each other body
-	//		- check collision and add to list
+	// 5. COLLISIONS: sweep-and-prune for candidate pairs
+	//		- swept checks for fast bodies, clamping them at the time of impact
+	//		- check each candidate pair both ways and add to list
 	//		- process all collisions when we've checked the lot
+	//		- then against static geometry
 	void SoftBodySystem::handleCollisions()
 	{
 		auto view = entityManager->find<Component::SoftBody, Component::Collider>();
@@ -286,25 +971,101 @@ namespace Squishies
 		// make sure we're starting fresh
 		m_collider.reset();
 
-		// loop the objects and see what's colliding
+		// refresh the broadphase with where everything is now
+		m_broadphase.begin();
 		view.each(
 			[&](wf::EntityID id, Component::SoftBody& softbody, Component::Collider& collider) {
-				view.each(
-					[&](wf::EntityID id2, Component::SoftBody& softbody2, Component::Collider& collider2) {
+				softbody.colliding = false;
+				m_broadphase.set(id, softbody, collider);
+			});
+		m_broadphase.end();
+
+		// and only check the candidate pairs, both ways round. each chunk of pairs gathers into its own buffer, and the
+		// buffers are merged in chunk order so the collision list comes out the same however many threads we have
+		const auto& pairs = m_broadphase.findPairs();
+
+		// fast movers first: any point that went through an edge this step is pulled back to just past it, so the
+		// discrete checks below catch it rather than it tunnelling through. one at a time, as a body can be in many pairs
+		for (const auto& pair : pairs) {
+			sweep(*pair.a, *pair.b);
+			sweep(*pair.b, *pair.a);
+		}
+		size_t chunkCount = std::min((pairs.size() + PAIR_GRAIN - 1) / PAIR_GRAIN, m_threadPool->getThreadCount() * 4);
+
+		if (m_chunkCollisions.size() < chunkCount) {
+			m_chunkCollisions.resize(chunkCount);
+		}
 
-						// no point if they're the same object or both fixed
-						if (id == id2 || (softbody.fixed && softbody2.fixed)) return;
+		m_threadPool->parallelFor(chunkCount,
+			[&](size_t begin, size_t end) {
+				for (size_t chunk = begin; chunk < end; chunk++) {
+					auto& out = m_chunkCollisions[chunk];
+					out.clear();
 
-						// group vs mask says no
-						if (!((collider.collisionMask & collider2.collisionGroup) && (collider2.collisionMask & collider.collisionGroup))) return;
+					size_t first = pairs.size() * chunk / chunkCount;
+					size_t last = pairs.size() * (chunk + 1) / chunkCount;
 
-						// now we can check
-						softbody.colliding = m_collider.check(softbody, softbody2);
-					});
+					for (size_t i = first; i < last; i++) {
+						const auto& pair = pairs[i];
+						m_collider.check(pair.idA, *pair.a, pair.idB, *pair.b, out);
+						m_collider.check(pair.idB, *pair.b, pair.idA, *pair.a, out);
+					}
+				}
 			});
 
-		// now handle any collisions we found
-		m_collider.respond();
+		for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+			m_collider.add(m_chunkCollisions[chunk]);
+		}
+
+		// something still on the move bumping into a sleeping body wakes it
+		for (const auto& info : m_collider.getCollisions()) {
+			wakeOnContact(*info.obj1, *info.obj2);
+			wakeOnContact(*info.obj2, *info.obj1);
+		}
+
+		// now handle any collisions we found; bodies that aren't touching can be pushed apart independently
+		m_collider.respond(*m_threadPool, m_simBodies.size());
+
+		// and the level has the final say
+		collideStatics();
+	}
+
+	// 5b. STATIC COLLISIONS: foreach body
+	//		- gather the static colliders around it from the grid (one at a time; the grid isn't safe to query concurrently)
+	//		- push its points out of them. statics never move, so bodies are independent and go in parallel
+	//		- then lift anything below a heightfield back onto it
+	void SoftBodySystem::collideStatics()
+	{
+		if (!m_staticGrid.size() && m_heightfields.empty()) return;
+
+		m_staticStart.resize(m_bodies.size() + 1);
+		m_staticCandidates.clear();
+
+		for (size_t i = 0; i < m_bodies.size(); i++) {
+			m_staticStart[i] = static_cast<uint32_t>(m_staticCandidates.size());
+
+			m_queryResults.clear();
+			if (m_staticGrid.size()) m_staticGrid.query(m_bodies[i]->boundingBox, m_queryResults);
+
+			for (auto id : m_queryResults) {
+				m_staticCandidates.push_back(&entityManager->get(static_cast<wf::EntityID>(id)).getComponent<Component::StaticCollider>());
+			}
+		}
+		m_staticStart[m_bodies.size()] = static_cast<uint32_t>(m_staticCandidates.size());
+
+		m_threadPool->parallelFor(m_bodies.size(),
+			[&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					for (uint32_t c = m_staticStart[i]; c < m_staticStart[i + 1]; c++) {
+						m_collider.collideStatic(*m_bodies[i], *m_staticCandidates[c]);
+					}
+
+					// the ground goes last; nothing should be left below it
+					for (const auto* field : m_heightfields) {
+						m_collider.collideHeightfield(*m_bodies[i], *field);
+					}
+				}
+			}, BODY_GRAIN);
 	}
 
 	// 6. POST-UPDATES: foreach body
@@ -313,29 +1074,114 @@ namespace Squishies
 	//			1. damp velocity by 0.999f
 	//			2. expand the collision box if the point is inside of another (gathered during collision check)
 	//		3. determine if the body is grounded
+	//		4. track how long the body has been resting
+	//		5. reset the step count for level of detail
 	//
 	// @todo grounded checks
-	void SoftBodySystem::postUpdates()
+	void SoftBodySystem::postUpdates(float dt)
 	{
-		entityManager->each<Component::SoftBody>(
+		forEachBody(
 			[&](Component::SoftBody& softbody) {
 
-				if (softbody.fixed) return;
-
 				softbody.collisionBox.reset();
 
-				// dampen velocities and expand our collision box with all points in collision, if any
-				for (auto& pt : softbody.points) {
-					pt.velocity *= .999f;
+				auto& pts = softbody.points;
 
-					if (pt.insideAnother) {
-						softbody.collisionBox.extend(pt.position);
+				// dampen velocities, once for each step we've covered
+				const float damping = softbody.lodSteps > 1 ? std::pow(.999f, static_cast<float>(softbody.lodSteps)) : .999f;
+				for (size_t i = 0; i < pts.paddedSize(); i++) {
+					pts.velX[i] *= damping;
+					pts.velY[i] *= damping;
+					pts.velZ[i] *= damping;
+				}
+
+				// expand our collision box with all points in collision, if any
+				for (size_t i = 0; i < pts.size(); i++) {
+					if (pts.isInsideAnother(i)) {
+						softbody.collisionBox.extend(pts.getPosition(i));
 					}
 
-					//wf::Debug::filledCircle(pt.position, 5.f, pt.insideAnother ? wf::RED : wf::YELLOW);
+					//wf::Debug::filledCircle(pts.getPosition(i), 5.f, pts.isInsideAnother(i) ? wf::RED : wf::YELLOW);
 				}
 
 				// @todo grounded check
+
+				// resting if both the body as a whole and its points (so no wobbling either) have next to no energy
+				const auto& config = Config::get();
+				if (config.sleeping && pts.size()) {
+					float pointEnergy = 0.f;
+					for (size_t i = 0; i < pts.size(); i++) {
+						pointEnergy += pts.velX[i] * pts.velX[i] + pts.velY[i] * pts.velY[i] + pts.velZ[i] * pts.velZ[i];
+					}
+					pointEnergy *= .5f / pts.size();
+
+					float bodyEnergy = .5f * glm::dot(softbody.derivedVelocity, softbody.derivedVelocity);
+
+					bool resting = pointEnergy < config.sleepEnergy && bodyEnergy < config.sleepEnergy;
+					softbody.sleepTimer = resting ? softbody.sleepTimer + dt * softbody.lodSteps : 0.f;
+				}
+
+				softbody.lodSteps = 0;
 			});
 	}
+
+	// 7. SLEEP: group the bodies into islands of things touching
+	//		- an island where every body has been resting long enough goes to sleep together
+	//		- fixed bodies don't join islands; everything resting on the floor isn't one big island
+	void SoftBodySystem::updateSleep()
+	{
+		const auto& config = Config::get();
+		if (!config.sleeping) return;
+
+		m_islands.reset(m_simBodies.size());
+
+		for (const auto& info : m_collider.getCollisions()) {
+			if (info.obj1->fixed || info.obj2->fixed) continue;
+			m_islands.join(info.obj1->solverIndex, info.obj2->solverIndex);
+		}
+
+		m_islandResting.assign(m_islands.build(), 1);
+
+		for (auto* softbody : m_simBodies) {
+			if (!softbody->sleeping && softbody->sleepTimer < config.sleepDelay) {
+				m_islandResting[m_islands.getIsland(softbody->solverIndex)] = 0;
+			}
+		}
+
+		for (auto* softbody : m_simBodies) {
+			if (!softbody->sleeping && m_islandResting[m_islands.getIsland(softbody->solverIndex)]) {
+				softbody->sleep();
+			}
+		}
+	}
+
+	void SoftBodySystem::sweep(Component::SoftBody& fast, const Component::SoftBody& other)
+	{
+		if (!fast.continuousCollision || !fast.isActive()) return;
+
+		// our edges and box have to follow any points that were pulled back
+		if (m_collider.sweep(fast, other)) {
+			fast.updateAll();
+		}
+	}
+
+	void SoftBodySystem::wakeOnContact(Component::SoftBody& sleeper, const Component::SoftBody& other)
+	{
+		// only if the other one is genuinely moving; two bodies settling onto each other shouldn't keep waking each other
+		if (sleeper.sleeping && other.isActive() && other.sleepTimer < Config::get().sleepDelay) {
+			sleeper.wake();
+		}
+	}
+
+	wf::BoundingBox SoftBodySystem::getWorldBounds() const
+	{
+		auto worldBounds = Config::get().worldBounds;
+
+		// the ground is the floor now; the bounds only keep things from wandering off sideways or up
+		if (!m_heightfields.empty()) {
+			worldBounds.min.y = -FLT_MAX;
+		}
+
+		return worldBounds;
+	}
 }
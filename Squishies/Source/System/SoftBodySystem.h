@@ -1,32 +1,249 @@
 #pragma once
 #include "Engine.h"
 
+#include "Utils/Broadphase.h"
 #include "Utils/Collider.h"
+#include "Utils/Islands.h"
+#include "Utils/PhysicsQuery.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
 namespace Squishies
 {
 	/**
 	 * @brief Main soft body system for handling the creation and physics of the Squishies
 	 */
-	class SoftBodySystem : public wf::ISystem
+	class SoftBodySystem : public wf::ISystem, public IPhysicsQuery
 	{
 	public:
+		/**
+		 * @brief How joints, shape matching and the world bounds are solved each step
+		 */
+		enum class Integrator
+		{
+			FORCES,													// spring forces and semi-implicit Euler; stiff bodies need small steps
+			XPBD,													// compliant position constraints over substeps; stays stable when stiff
+		};
+
+		/**
+		 * @brief Where a body was as of a published snapshot
+		 */
+		struct BodyState
+		{
+			wf::EntityID id{};
+			wf::Vec3 derivedPosition{};
+			wf::Quat derivedRotation{};
+			wf::Vec3 derivedVelocity{};
+			wf::BoundingBox boundingBox{};
+			wf::Vec3 lastPosition{};								// derived position as of the step before
+			bool sleeping{ false };
+			bool stepped{ false };									// moved in the last step, so can be drawn between the two
+			uint32_t firstPoint{ 0 };								// where its points start in the snapshot
+			uint32_t pointCount{ 0 };
+		};
+
+		/**
+		 * @brief Every body's points and derived data at the end of a run of steps
+		 */
+		struct Snapshot
+		{
+			std::vector<BodyState> bodies;							// sorted by entity
+			std::vector<float> posX, posY, posZ;					// all of the bodies' points, one after the other
+			std::vector<float> lastX, lastY, lastZ;					// and where they were the step before
+
+			/**
+			 * @brief Find a body's state, or null if it wasn't around when the snapshot was taken
+			 */
+			const BodyState* find(wf::EntityID id) const;
+		};
+
 		SoftBodySystem(wf::Scene* scene);
+		~SoftBodySystem();
 
 		virtual bool init() override;
 		virtual void update(float dt) override;
 		virtual void fixedUpdate(float dt) override;
 
+		// IPhysicsQuery
+		virtual void queryRegion(const wf::BoundingBox& region, std::vector<wf::EntityID>& out, const QueryFilter& filter = {}) override;
+		virtual void queryRadius(const wf::Vec3& centre, float radius, std::vector<wf::EntityID>& out, const QueryFilter& filter = {}) override;
+		virtual bool raycast(const wf::Ray& ray, float maxDistance, QueryHit& hit, const QueryFilter& filter = {}) override;
+		virtual bool nearest(const wf::Vec3& point, float maxDistance, QueryHit& hit, const QueryFilter& filter = {}) override;
+
+		/**
+		 * @brief Set how many threads the simulation is spread over. 0 for one per hardware thread, 1 for single threaded.
+		 *
+		 * Results are identical whatever the count.
+		 */
+		void setThreadCount(size_t count);
+
+		/**
+		 * @brief The pool the simulation is spread over, for the other physics systems to share rather than starting their
+		 * own. Only from the main thread, and with a simulation thread, not between launching and syncing it
+		 */
+		wf::ThreadPool& getThreadPool() { return *m_threadPool; }
+
+		/**
+		 * @brief Step the bodies on a dedicated simulation thread rather than in fixedUpdate().
+		 *
+		 * fixedUpdate() then only records the steps; launchSimulation() sets them running, to overlap with the render and
+		 * the wait for vsync, and syncSimulation() waits for them to finish. Nothing else may touch the bodies between the
+		 * two; changes made then go through post(). The bodies are drawn from the published snapshots, so what's on screen
+		 * is a frame behind the simulation.
+		 *
+		 * Not while any coupled system is registered: those push on the bodies from their own fixedUpdate(), which would
+		 * then land on bodies that haven't stepped yet, every step's worth on the same state. Enabling it does nothing then.
+		 */
+		void setSimulationThread(bool enabled);
+		bool isSimulationThreaded() const { return m_threaded; }
+
+		/**
+		 * @brief Register a system that pushes on the bodies from its own fixed step (the liquid, the rigid bodies). Its
+		 * steps have to interleave with ours, so this turns the simulation thread off, and keeps it off
+		 */
+		void addCoupledSystem();
+		bool hasCoupledSystems() const { return m_coupledSystems > 0; }
+
+		/**
+		 * @brief Start the steps recorded since the last launch on the simulation thread. Does nothing without one
+		 */
+		void launchSimulation();
+
+		/**
+		 * @brief Wait for the simulation thread to finish its steps, then run anything posted meanwhile
+		 */
+		void syncSimulation();
+
+		/**
+		 * @brief Run a change to the bodies or the system once nothing is stepping them: straight away without a simulation
+		 * thread, otherwise at the next syncSimulation()
+		 */
+		void post(std::function<void()> command);
+
+		/**
+		 * @brief The newest snapshot picked up by update(). Only kept with a simulation thread; without one, read the bodies
+		 */
+		const Snapshot& getSnapshot() const { return m_snapshots.getReadBuffer(); }
+
+		/**
+		 * @brief Choose the integrator, and for XPBD how many substeps each fixed step is split into.
+		 *
+		 * If adaptive, substeps is the most each body can use; each picks what it needs from how fast its points are
+		 * moving and how stiff it is.
+		 */
+		void setIntegrator(Integrator integrator, uint32_t substeps = 8, bool adaptive = false);
+		Integrator getIntegrator() const { return m_integrator; }
+		uint32_t getSubsteps() const { return m_substeps; }
+		bool isAdaptive() const { return m_adaptive; }
+
 	private:
+		static constexpr size_t BODY_GRAIN = 8;						// min bodies per parallel chunk
+		static constexpr size_t PAIR_GRAIN = 4;						// min collision pairs per parallel chunk
+
+		void step(float dt);
+		void simulationLoop();
+		void publishSnapshot();
+		void gatherBodies();
 		void createSquishy(wf::Entity entity);
+		void createStaticCollider(wf::Entity entity);
+		void createHeightfieldCollider(wf::Entity entity);
 		void prepareAndAccumulateForces();
 		void integrate(float dt);
 		void hardConstraints();
+		void solvePositions(float dt);
+		uint32_t chooseSubsteps(const Component::SoftBody& softbody, float dt) const;
 		void metaUpdates();
 		void handleCollisions();
-		void postUpdates();
+		void collideStatics();
+		void postUpdates(float dt);
+		void updateSleep();
+		void sweep(Component::SoftBody& fast, const Component::SoftBody& other);
+		void wakeOnContact(Component::SoftBody& sleeper, const Component::SoftBody& other);
+		wf::BoundingBox getWorldBounds() const;
+
+		/**
+		 * @brief Candidates from the grid for a region of the XY plane that pass the filter, into m_queryBodies
+		 */
+		void gatherQueryBodies(const wf::Vec2& min, const wf::Vec2& max, const QueryFilter& filter);
+
+		/**
+		 * @brief Candidates from the grid cells along a segment of the XY plane that pass the filter, into m_queryBodies
+		 */
+		void gatherRayBodies(const wf::Vec2& from, const wf::Vec2& to, const QueryFilter& filter);
+
+		/**
+		 * @brief Keep the grid's results that pass the filter and have a box reaching into the region
+		 */
+		void filterQueryBodies(const wf::Vec2& min, const wf::Vec2& max, const QueryFilter& filter);
+
+		/**
+		 * @brief Closest point on the body's outline, if it's nearer than maxDistSq
+		 */
+		static EdgeKernels::Closest closestEdge(const Component::SoftBody& softbody, const wf::Vec2& pt, float maxDistSq);
 
 	private:
 		Collider m_collider;
+		SweepAndPrune m_broadphase;
+		wf::SpatialHashGrid m_grid;
+		wf::SpatialHashGrid m_staticGrid;							// static colliders; only changes when they come or go
+		std::vector<uint32_t> m_staticStart;						// per gathered body, where its candidates start in m_staticCandidates
+		std::vector<const Component::StaticCollider*> m_staticCandidates;
+		std::vector<const wf::Heightfield*> m_heightfields;		// gathered each step; there's rarely more than one
+		std::vector<uint32_t> m_queryResults;
+		std::vector<std::pair<wf::EntityID, const Component::SoftBody*>> m_queryBodies;	// candidates for the current query
+		std::vector<std::pair<float, uint32_t>> m_queryOrder;		// raycast: where it enters each candidate's box
+
+		uint64_t m_stepCount{ 0 };									// fixed steps so far, for staggering level of detail
+		Integrator m_integrator{ Integrator::FORCES };
+		uint32_t m_substeps{ 8 };
+		bool m_adaptive{ false };
+
+		std::unique_ptr<wf::ThreadPool> m_threadPool;
+		std::vector<Component::SoftBody*> m_simBodies;				// non-fixed bodies, gathered each step
+		std::vector<Component::SoftBody*> m_bodies;				// the ones of those that are awake
+		std::vector<std::vector<CollisionData>> m_chunkCollisions;	// narrowphase output per chunk of pairs
+
+		// simulation thread. the steps are recorded on the main thread and handed over whole at launch
+		bool m_threaded{ false };
+		uint32_t m_coupledSystems{ 0 };								// stepping alongside us in fixedUpdate(); no thread while any are
+		std::thread m_simThread;
+		std::mutex m_simMutex;
+		std::condition_variable m_simWake;
+		std::condition_variable m_simDone;
+		bool m_simBusy{ false };
+		bool m_simStopping{ false };
+		std::vector<float> m_queuedSteps;							// recorded by fixedUpdate() for the next launch
+		std::vector<float> m_runningSteps;							// being stepped on the simulation thread
+		std::optional<wf::CameraComponent> m_simCamera;			// the camera as it was at launch, for level of detail
+
+		std::mutex m_commandMutex;
+		std::vector<std::function<void()>> m_commands;				// posted while the simulation thread was running
+		std::vector<std::function<void()>> m_runningCommands;
+
+		wf::TripleBuffer<Snapshot> m_snapshots;
+
+		IslandBuilder m_islands;
+		std::vector<uint8_t> m_islandResting;						// per island, whether everything on it is ready to sleep
+
+		/**
+		 * @brief Run a function over each gathered body, spread over the thread pool
+		 */
+		template<typename Func>
+		void forEachBody(Func&& func)
+		{
+			m_threadPool->parallelFor(m_bodies.size(),
+				[&](size_t begin, size_t end) {
+					for (size_t i = begin; i < end; i++) {
+						func(*m_bodies[i]);
+					}
+				}, BODY_GRAIN);
+		}
 	};
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "WeaponSystem.h"
 
-#include "Component/CharacterComponent.h"
 #include "Component/ColliderComponent.h"
 #include "Component/GrenadeComponent.h"
 #include "Component/SoftBodyComponent.h"
@@ -18,10 +17,16 @@
 
 namespace Squishies
 {
+	WeaponSystem::WeaponSystem(wf::Scene* scene, IPhysicsQuery* physics)
+		:ISystem(scene), m_physics(physics)
+	{
+	}
+
 	bool WeaponSystem::init()
 	{
 		// @todo we might us an ellipse if it had actual rotation when thrown
-		m_grenadeProto = std::make_shared<Squishy>(SquishyFactory::createEllipse(.25f, .25f, 9, 4, wf::DARKGREY));
+		m_grenadeProto = ShapeAsset::create(SquishyFactory::createEllipse(.25f, .25f, 9, 4, wf::DARKGREY));
+		m_grenadeMaterial = wf::createBasicMaterial();
 
 		eventDispatcher->on<event::DeployWeapon>([&](event::DeployWeapon& e) {
 			spawnGrenade(e);
@@ -50,8 +55,9 @@ namespace Squishies
 	void WeaponSystem::spawnGrenade(event::DeployWeapon& detail)
 	{
 		auto ent = scene->createObject(detail.position);
-		auto& material = ent.addComponent<wf::MeshRendererComponent>();
-		auto& body = ent.addComponent<Component::SoftBody>(*m_grenadeProto.get());
+		ent.addComponent<wf::MeshRendererComponent>().material = m_grenadeMaterial;
+		auto& body = ent.addComponent<Component::SoftBody>(m_grenadeProto);
+		body.continuousCollision = true;
 		auto& nade = ent.addComponent<Component::Grenade>(detail.player);
 
 		// collider
@@ -59,9 +65,7 @@ namespace Squishies
 
 		auto vel = glm::normalize(detail.target - detail.position) * detail.power;;
 
-		for (auto& pt : body.points) {
-			pt.velocity = vel;
-		}
+		body.points.setVelocities(vel);
 
 		wf::createTimer(nade.timer, [ent, this](wf::CustomTimer& timer) mutable {
 
@@ -78,47 +82,37 @@ namespace Squishies
 
 	void WeaponSystem::explode(event::Explosion& detail)
 	{
-		entityManager->each<Component::SoftBody>(
-			[&](wf::EntityID playerId, Component::SoftBody& softbody) {
-
-				// not a player
-				if (!entityManager->get(playerId).hasComponent<Component::Character>()) return;
-
-				// 1. see if the blast radius reaches our bounding box
-				const wf::Vec2 corners[4] = {
-					softbody.boundingBox.min,
-					{ softbody.boundingBox.max.x, softbody.boundingBox.min.y },
-					softbody.boundingBox.max,
-					{ softbody.boundingBox.min.x, softbody.boundingBox.max.y }
-				};
-
-				bool outside = true;
-				for (const auto& corner : corners) {
-					float dist2 = glm::length2(wf::Vec2(detail.position) - corner);
-					if (dist2 <= detail.radius * detail.radius) {
-						outside = false;
-						break;
-					}
-				}
+		// only the players whose outline the blast reaches
+		QueryFilter players;
+		players.collisionMask = CollisionGroup::CHARACTER;
 
-				if (outside) return;
+		m_nearby.clear();
+		m_physics->queryRadius(detail.position, detail.radius, m_nearby, players);
 
-				// 2. check the points
-				std::vector<std::pair<unsigned int, float>> hitpoints;
+		for (auto playerId : m_nearby) {
+			auto player = entityManager->get(playerId);
 
-				for (unsigned int i = 0; i < softbody.points.size(); i++) {
-					float distSq = glm::length2(softbody.points[i].position - detail.position);
+			// split by an earlier one in the same blast
+			if (!player.isValid()) continue;
 
-					if (distSq <= detail.radius * detail.radius) {
-						hitpoints.push_back({ i, distSq });
-					}
-				}
+			auto& softbody = player.getComponent<Component::SoftBody>();
 
-				// 3. if we have points, dispatch the event
-				if (hitpoints.size()) {
-					event::SplitSquishy e(entityManager->get(playerId), hitpoints, detail.position, detail.power);
-					eventDispatcher->dispatch<event::SplitSquishy>(e);
+			// 1. check the points
+			std::vector<std::pair<unsigned int, float>> hitpoints;
+
+			for (unsigned int i = 0; i < softbody.points.size(); i++) {
+				float distSq = glm::length2(softbody.points.getPosition(i) - detail.position);
+
+				if (distSq <= detail.radius * detail.radius) {
+					hitpoints.push_back({ i, distSq });
 				}
-			});
+			}
+
+			// 2. if we have points, dispatch the event
+			if (hitpoints.size()) {
+				event::SplitSquishy e(player, hitpoints, detail.position, detail.power);
+				eventDispatcher->dispatch<event::SplitSquishy>(e);
+			}
+		}
 	}
 }
\ No newline at end of file
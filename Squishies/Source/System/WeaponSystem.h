@@ -3,17 +3,17 @@
 
 #include "Event/DeployWeapon.h"
 #include "Event/Explosion.h"
+#include "Poly/ShapeAsset.h"
+#include "Utils/PhysicsQuery.h"
 
 #include <memory>
 
 namespace Squishies
 {
-	struct Squishy;
-
 	class WeaponSystem : public wf::ISystem
 	{
 	public:
-		using wf::ISystem::ISystem;
+		WeaponSystem(wf::Scene* scene, IPhysicsQuery* physics);
 
 		virtual bool init() override;
 		virtual void update(float dt) override;
@@ -23,6 +23,9 @@ namespace Squishies
 		void explode(event::Explosion& detail);
 
 	private:
-		std::shared_ptr<Squishy> m_grenadeProto;
+		ShapeHandle m_grenadeProto;								// shared by every grenade thrown
+		wf::Material m_grenadeMaterial;							// likewise, so they're drawn together
+		IPhysicsQuery* m_physics{ nullptr };
+		std::vector<wf::EntityID> m_nearby;
 	};
 }
\ No newline at end of file
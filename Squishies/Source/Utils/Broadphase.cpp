@@ -0,0 +1,101 @@
+#include "Broadphase.h"
+
+#include <vector>
+
+namespace Squishies
+{
+	void SweepAndPrune::begin()
+	{
+		for (auto& proxy : m_proxies) {
+			proxy.seen = false;
+			proxy.body = nullptr;
+		}
+	}
+
+	void SweepAndPrune::set(wf::EntityID id, Component::SoftBody& body, const Component::Collider& collider)
+	{
+		auto it = m_lookup.find(id);
+
+		if (it == m_lookup.end()) {
+			// new arrivals go on the end; the insertion sort will walk them into place
+			it = m_lookup.emplace(id, m_proxies.size()).first;
+			m_proxies.emplace_back();
+		}
+
+		auto& proxy = m_proxies[it->second];
+		proxy.id = id;
+		proxy.body = &body;
+		proxy.collisionGroup = collider.collisionGroup;
+		proxy.collisionMask = collider.collisionMask;
+		proxy.minX = body.boundingBox.min.x;
+		proxy.maxX = body.boundingBox.max.x;
+		proxy.seen = true;
+	}
+
+	void SweepAndPrune::end()
+	{
+		// drop anything that's gone away. erase_if is stable so the remaining order is preserved
+		std::erase_if(m_proxies, [&](const Proxy& proxy) {
+			if (!proxy.seen) {
+				m_lookup.erase(proxy.id);
+				return true;
+			}
+			return false;
+			});
+
+		insertionSort();
+
+		// indices have shifted around, so refresh the lookup. keys all exist already so nothing allocates here
+		for (size_t i = 0; i < m_proxies.size(); i++) {
+			m_lookup[m_proxies[i].id] = i;
+		}
+	}
+
+	const std::vector<BroadphasePair>& SweepAndPrune::findPairs()
+	{
+		m_pairs.clear();
+
+		for (size_t i = 0; i < m_proxies.size(); i++) {
+			const auto& a = m_proxies[i];
+			if (!a.body->boundingBox.isValid) continue;
+
+			// everything after us starts further along; once something starts past our end, so does everything after it
+			for (size_t j = i + 1; j < m_proxies.size() && m_proxies[j].minX <= a.maxX; j++) {
+				const auto& b = m_proxies[j];
+
+				if (!canCollide(a, b)) continue;
+				if (!a.body->boundingBox.intersects(b.body->boundingBox)) continue;
+
+				m_pairs.push_back({ a.body, b.body, a.id, b.id });
+			}
+		}
+
+		return m_pairs;
+	}
+
+	void SweepAndPrune::insertionSort()
+	{
+		for (size_t i = 1; i < m_proxies.size(); i++) {
+			if (m_proxies[i - 1].minX <= m_proxies[i].minX) continue;
+
+			Proxy proxy = m_proxies[i];
+			size_t j = i;
+
+			while (j > 0 && m_proxies[j - 1].minX > proxy.minX) {
+				m_proxies[j] = m_proxies[j - 1];
+				j--;
+			}
+
+			m_proxies[j] = proxy;
+		}
+	}
+
+	bool SweepAndPrune::canCollide(const Proxy& a, const Proxy& b)
+	{
+		// no point if neither can move (fixed or asleep)
+		if (!a.body->isActive() && !b.body->isActive()) return false;
+
+		// group vs mask says no
+		return (a.collisionMask & b.collisionGroup) && (b.collisionMask & a.collisionGroup);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Engine.h"
+#include "Component/ColliderComponent.h"
+#include "Component/SoftBodyComponent.h"
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Broadphase collision culling.
+ *
+ * Persistent sweep-and-prune along the X axis. Bodies keep their place in the sorted list between steps, so as things
+ * only move a little each step the insertion sort that restores the order is close to linear.
+ */
+namespace Squishies
+{
+	struct BroadphasePair
+	{
+		Component::SoftBody* a{ nullptr };
+		Component::SoftBody* b{ nullptr };
+		wf::EntityID idA{};
+		wf::EntityID idB{};
+	};
+
+	class SweepAndPrune
+	{
+	public:
+		SweepAndPrune() = default;
+		~SweepAndPrune() = default;
+
+		/**
+		 * @brief Start a refresh of the tracked bodies. Anything not passed to set() before end() is dropped
+		 */
+		void begin();
+
+		/**
+		 * @brief Add or update a body. Pointers are refreshed each step, so component storage moving about is fine
+		 */
+		void set(wf::EntityID id, Component::SoftBody& body, const Component::Collider& collider);
+
+		/**
+		 * @brief Drop stale bodies and restore the sort order
+		 */
+		void end();
+
+		/**
+		 * @brief Sweep the sorted list for overlapping, collidable pairs
+		 *
+		 * Pairs are filtered by collision group/mask and by neither body being active (fixed or asleep), and come out in sweep order
+		 * so the result is deterministic for the same input.
+		 */
+		const std::vector<BroadphasePair>& findPairs();
+
+		size_t size() const { return m_proxies.size(); }
+
+	private:
+		struct Proxy
+		{
+			wf::EntityID id{};
+			Component::SoftBody* body{ nullptr };
+			int collisionGroup{};
+			int collisionMask{};
+			float minX{};
+			float maxX{};
+			bool seen{ false };
+		};
+
+		void insertionSort();
+		static bool canCollide(const Proxy& a, const Proxy& b);
+
+	private:
+		std::vector<Proxy> m_proxies;								// kept sorted on minX between steps
+		std::unordered_map<wf::EntityID, size_t> m_lookup;			// entity -> index in m_proxies
+		std::vector<BroadphasePair> m_pairs;
+	};
+}
@@ -1,6 +1,9 @@
 #include "Collider.h"
 #include "Engine.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
@@ -20,18 +23,20 @@ namespace Squishies
 
 	void Collider::reset()
 	{
+		// remember where everything was touching, for the next lot of checks
+		m_contactCache.clear();
+		for (const auto& info : m_collisions) {
+			ContactKey key{ info.obj1Id, static_cast<uint32_t>(info.obj1Point), info.obj2Id };
+			m_contactCache[key] = static_cast<uint32_t>(info.obj2PointA);
+		}
+
 		m_collisions.clear();
 	}
 
 	// @todo initial checks around whether the objects are the same, or both fixed, or not collidable, etc - things we'll want configured later in our
 	//		bodies.
-	bool Collider::check(Component::SoftBody& obj1, Component::SoftBody& obj2)
+	bool Collider::check(wf::EntityID id1, Component::SoftBody& obj1, wf::EntityID id2, Component::SoftBody& obj2, std::vector<CollisionData>& out) const
 	{
-		// bitmask check..
-		if (!obj1.bitFields.same(obj2.bitFields)) {
-			return false;
-		}
-
 		// bounding boxes collide at least?
 		if (!obj1.boundingBox.intersects(obj2.boundingBox)) {
 			return false;
@@ -47,26 +52,23 @@ namespace Squishies
 
 		////now we can do some more involved checks.
 		size_t bApmCount = obj1.points.size();
-		size_t bBpmCount = obj2.points.size();
 		auto boxB = obj2.boundingBox;
 
-		CollisionData infoAway;
-		CollisionData infoSame;
 		bool hasCollisions = false;
 
 		for (size_t i = 0; i < bApmCount; i++) {
-			wf::Vec2 pt = obj1.points[i].position;
+			wf::Vec2 pt = { obj1.points.posX[i], obj1.points.posY[i] };
 
 			// check if the point is even inside the other shape. a simple bb check, then a poly check if necessary.
 			if (!boxB.contains(wf::Vec3{ pt, 0.f })) continue;
 
-			if (!checkCollisionPoint(pt, obj2.points)) continue;
+			if (!obj2.edgeTree.containsPoint(pt, obj2.edges)) continue;
 
-			size_t prevPt = (i > 0) ? 0 : bApmCount - 1;
+			size_t prevPt = (i + bApmCount - 1) % bApmCount;
 			size_t nextPt = (i + 1) % bApmCount;
 
-			wf::Vec2 prev = obj1.points[prevPt].position;
-			wf::Vec2 next = obj1.points[nextPt].position;
+			wf::Vec2 prev = { obj1.points.posX[prevPt], obj1.points.posY[prevPt] };
+			wf::Vec2 next = { obj1.points.posX[nextPt], obj1.points.posY[nextPt] };
 
 			wf::Vec2 fromPrev = pt - prev;
 			wf::Vec2 toNext = next - pt;
@@ -74,229 +76,575 @@ namespace Squishies
 			wf::Vec2 v = fromPrev + toNext;
 			wf::Vec2 ptNorm = glm::vec2(-v.y, v.x);
 
-			float closestAway = 100000.0f;
-			float closestSame = 100000.0f;
-
-			infoAway.clear();
-			infoAway.obj1 = &obj1;
-			infoAway.obj1Point = i;
-			infoAway.obj2 = &obj2;
-
-			infoSame.clear();
-			infoSame.obj1 = &obj1;
-			infoSame.obj1Point = i;
-			infoSame.obj2 = &obj2;
-
-			bool found = false;
-			size_t b1 = 0;
-			size_t b2 = 1;
-
-			for (size_t j = 0; j < bBpmCount; j++) {
-				wf::Vec2 hitPt;
-				wf::Vec2 norm;
-				float edgeD;
-
-				b1 = j;
-				b2 = (j + 1) % bBpmCount;
-
-				EdgeCol ec = getClosestPointOnEdgeSquared(pt, obj2.edges[j]);
-				float dist = ec.dist;
-
-				hitPt = ec.hitPoint;
-				norm = ec.normal;
-				edgeD = ec.edgeD;
-
-				float dot = glm::dot(ptNorm, norm);
-
-				if (dot <= 0.f) {
-					if (dist < closestAway) {
-						closestAway = dist;
-						infoAway.obj2PointA = b1;
-						infoAway.obj2PointB = b2;
-						infoAway.edgeD = edgeD;
-						infoAway.hitPoint = hitPt;
-						infoAway.normal = norm;
-						infoAway.penetrationSq = dist;
-						found = true;
-					}
-				}
-				else {
-					if (dist < closestSame) {
-						closestSame = dist;
-						infoSame.obj2PointA = b1;
-						infoSame.obj2PointB = b2;
-						infoSame.edgeD = edgeD;
-						infoSame.hitPoint = hitPt;
-						infoSame.normal = norm;
-						infoSame.penetrationSq = dist;
-					}
-				}
-			}
+			// in contact last step? that edge is the likeliest answer again
+			auto cached = m_contactCache.find({ id1, static_cast<uint32_t>(i), id2 });
+			size_t seed = cached != m_contactCache.end() ? cached->second : SIZE_MAX;
 
-			if (found && (closestAway > m_penetrationThreshold) && (closestSame < closestAway)) {
-				obj1.points[infoSame.obj1Point].insideAnother = true;
-				m_collisions.push_back(infoSame);
-				hasCollisions = true;
-			}
-			else {
-				obj1.points[infoAway.obj1Point].insideAnother = true;
-				m_collisions.push_back(infoAway);
-				hasCollisions = true;
-			}
+			EdgeKernels::Closest edge = findEdge(obj2.edges, obj2.edgeTree, pt, ptNorm, seed);
+
+			if (!edge.found()) continue;
+
+			CollisionData info = makeCollision(obj1, i, obj2, edge);
+			info.obj1Id = id1;
+			info.obj2Id = id2;
+
+			out.push_back(info);
+			hasCollisions = true;
 		}
 
 		return hasCollisions;
 	}
 
-	void Collider::respond()
+	bool Collider::sweep(Component::SoftBody& fast, const Component::SoftBody& other) const
 	{
-		int penCount = 0;
+		auto& pts = fast.points;
+		const auto& edges = other.edges;
 
-		for (size_t i = 0; i < m_collisions.size(); i++) {
-			const CollisionData& info = m_collisions[i];
-
-			// @todo this was quite useful but maybe a better way now we know what we're doing a bit more...
-			/*if (NotifyCollision(info)) {
-				continue;
-			}*/
-
-			auto& pointA = info.obj1->points[info.obj1Point];
-			auto& pointB1 = info.obj2->points[info.obj2PointA];
-			auto& pointB2 = info.obj2->points[info.obj2PointB];
-
-			bool pointAFixed = pointA.fixed || pointA.mass == 0.f || info.obj1->fixed;
-			bool pointB1Fixed = pointB1.fixed || pointB1.mass == 0.f || info.obj2->fixed;
-			bool pointB2Fixed = pointB2.fixed || pointB2.mass == 0.f || info.obj2->fixed;
-
-			// fixme doing this also for kinematics, but this might be better to use derivedVelocity...if we calc it for kinematic objects.
-			wf::Vec2 bVel = ((pointB1Fixed ? wf::Vec2{} : wf::Vec2(pointB1.velocity)) + (pointB2Fixed ? wf::Vec2{} : pointB2.velocity)) * .5f;
-			wf::Vec2 relVel = wf::Vec2(pointA.velocity) - bVel;
-			float relDot = glm::dot(relVel, info.normal);
-
-			// nothing to do if the points are moving away from eachother already @todo assess this
-			/*if (relDot >= 0.f) {
-				continue;
-			}*/
-
-			if (info.penetrationSq > (m_penetrationThreshold * m_penetrationThreshold)) {
-				penCount++;
-				continue;
-			}
+		bool moved = false;
+
+		for (size_t i = 0; i < pts.size(); i++) {
+			wf::Vec2 from = { pts.lastX[i], pts.lastY[i] };
+			wf::Vec2 to = { pts.posX[i], pts.posY[i] };
 
-			float penetration = sqrt(info.penetrationSq);
+			float hitT = 1.f;
+			size_t hitEdge = firstCrossing(edges, other.edgeTree, from, to, hitT);
 
-			float b1inf = 1.f - info.edgeD;
-			float b2inf = info.edgeD;
+			if (hitEdge == SIZE_MAX) continue;
 
-			float b2MassSum = (pointB1Fixed || pointB2Fixed) ? std::numeric_limits<float>::infinity() : (pointB1.mass + pointB2.mass);
-			float massSum = pointA.mass + b2MassSum;
+			// leave it just inside, so check() sees it and the normal response takes over
+			wf::Vec2 clamped = from + (to - from) * hitT - edges.getNormal(hitEdge) * m_sweepSkin;
+			pts.posX[i] = clamped.x;
+			pts.posY[i] = clamped.y;
+			moved = true;
+		}
 
-			float Amove = 0.f;
-			float Bmove = 0.f;
+		return moved;
+	}
 
-			if (pointAFixed) {
-				Bmove = penetration + 0.001f;
-			}
-			else if (std::isinf(b2MassSum)) {
-				Amove = penetration + 0.001f;
+	bool Collider::collideStatic(Component::SoftBody& body, const Component::StaticCollider& fixture) const
+	{
+		if (!body.boundingBox.intersects(fixture.boundingBox)) {
+			return false;
+		}
+
+		auto& pts = body.points;
+		const auto& edges = fixture.edges;
+		const size_t count = pts.size();
+
+		bool hit = false;
+
+		for (size_t i = 0; i < count; i++) {
+			if (pts.isFixed(i)) continue;
+
+			wf::Vec2 pt = { pts.posX[i], pts.posY[i] };
+
+			if (fixture.closed) {
+				// same as a point inside a fixed body, minus anything to do with moving the other side
+				if (!fixture.boundingBox.contains(wf::Vec3{ pt, 0.f })) continue;
+				if (!fixture.edgeTree.containsPoint(pt, edges)) continue;
+
+				wf::Vec2 prev = { pts.posX[(i + count - 1) % count], pts.posY[(i + count - 1) % count] };
+				wf::Vec2 next = { pts.posX[(i + 1) % count], pts.posY[(i + 1) % count] };
+				wf::Vec2 v = next - prev;
+				wf::Vec2 ptNorm = glm::vec2(-v.y, v.x);
+
+				EdgeKernels::Closest edge = findEdge(edges, fixture.edgeTree, pt, ptNorm, SIZE_MAX);
+				if (!edge.found()) continue;
+
+				if (edge.distSq > m_penetrationThreshold * m_penetrationThreshold) continue;
+
+				resolveStatic(pts, i, edges.getNormal(edge.edge), sqrt(edge.distSq) + 0.001f);
 			}
 			else {
-				Amove = (penetration * (b2MassSum / massSum));
-				Bmove = (penetration * (pointA.mass / massSum));
+				// nothing's inside a line, so catch points crossing it from the open side instead
+				wf::Vec2 from = { pts.lastX[i], pts.lastY[i] };
+
+				float hitT = 1.f;
+				size_t hitEdge = firstCrossing(edges, fixture.edgeTree, from, pt, hitT);
+				if (hitEdge == SIZE_MAX) continue;
+
+				wf::Vec2 normal = edges.getNormal(hitEdge);
+				wf::Vec2 clamped = from + (pt - from) * hitT;
+
+				resolveStatic(pts, i, normal, glm::dot(clamped - pt, normal) + m_sweepSkin);
 			}
 
-			float pointB1move = Bmove * b1inf;
-			float pointB2move = Bmove * b2inf;
+			pts.setInsideAnother(i);
+			hit = true;
+		}
 
-			float AinvMass = pointAFixed ? 0.f : 1.f / pointA.mass;
-			float BinvMass = std::isinf(b2MassSum) ? 0.f : 1.f / b2MassSum;
+		if (hit) body.colliding = true;
 
-			float jDenom = AinvMass + BinvMass;
-			wf::Vec2 numV = relVel * (1.f + m_elasticity);
+		return hit;
+	}
 
-			float jNumerator = glm::dot(numV, info.normal);
-			jNumerator = -jNumerator;
+	bool Collider::collideRigid(Component::SoftBody& body, const Component::RigidBody& rigid, wf::Vec2& linearImpulse, float& angularImpulse) const
+	{
+		if (!body.boundingBox.intersects(rigid.boundingBox)) {
+			return false;
+		}
 
-			float j = jNumerator / jDenom;
+		auto& pts = body.points;
+		const auto& edges = rigid.edges;
+		const size_t count = pts.size();
 
-			if (!pointAFixed) {
-				pointA.position += wf::Vec3(info.normal * Amove, 0.f);
-			}
+		bool hit = false;
 
-			if (!pointB1Fixed) {
-				pointB1.position -= wf::Vec3(info.normal * pointB1move, 0.f);
+		for (size_t i = 0; i < count; i++) {
+			// sleeping and fixed points hold still; the rigid body still bounces off them
+			const float pointInvMass = (pts.isFixed(i) || !body.isActive()) ? 0.f : pts.getInvMass(i);
+			if (pointInvMass == 0.f && rigid.invMass == 0.f) continue;
+
+			wf::Vec2 pt = { pts.posX[i], pts.posY[i] };
+
+			if (!rigid.boundingBox.contains(wf::Vec3{ pt, 0.f })) continue;
+			if (!rigid.edgeTree.containsPoint(pt, edges)) continue;
+
+			wf::Vec2 prev = { pts.posX[(i + count - 1) % count], pts.posY[(i + count - 1) % count] };
+			wf::Vec2 next = { pts.posX[(i + 1) % count], pts.posY[(i + 1) % count] };
+			wf::Vec2 v = next - prev;
+			wf::Vec2 ptNorm = glm::vec2(-v.y, v.x);
+
+			EdgeKernels::Closest edge = findEdge(edges, rigid.edgeTree, pt, ptNorm, SIZE_MAX);
+			if (!edge.found()) continue;
+
+			if (edge.distSq > m_penetrationThreshold * m_penetrationThreshold) continue;
+
+			const wf::Vec2 normal = edges.getNormal(edge.edge);
+
+			// the rigid body isn't moved here, so the point takes all of the push. Bullet sorts out the rest next step
+			if (pointInvMass > 0.f) {
+				pts.posX[i] += normal.x * (sqrt(edge.distSq) + 0.001f);
+				pts.posY[i] += normal.y * (sqrt(edge.distSq) + 0.001f);
 			}
 
-			if (!pointB2Fixed) {
-				pointB2.position -= wf::Vec3(info.normal * pointB2move, 0.f);
+			const wf::Vec2 r = edge.hitPoint - rigid.centre;
+			const wf::Vec2 pointVel = pointInvMass > 0.f ? wf::Vec2{ pts.velX[i], pts.velY[i] } : wf::Vec2{};
+			const wf::Vec2 relVel = pointVel - rigid.getVelocityAt(edge.hitPoint);
+			const float relDot = glm::dot(relVel, normal);
+
+			if (relDot < 0.f) {
+				const wf::Vec2 tangent = wf::perpCCW(normal);
+				const float rn = wf::cross2D(r, normal);
+				const float rt = wf::cross2D(r, tangent);
+
+				float j = -(1.f + m_elasticity) * relDot / (pointInvMass + rigid.invMass + rn * rn * rigid.invInertia);
+
+				float jtDenom = pointInvMass + rigid.invMass + rt * rt * rigid.invInertia;
+				float jt = jtDenom > 0.f ? std::clamp(-glm::dot(relVel, tangent) / jtDenom, -m_friction * j, m_friction * j) : 0.f;
+
+				wf::Vec2 impulse = normal * j + tangent * jt;
+
+				pts.velX[i] += impulse.x * pointInvMass;
+				pts.velY[i] += impulse.y * pointInvMass;
+
+				linearImpulse -= impulse;
+				angularImpulse -= wf::cross2D(r, impulse);
 			}
 
-			wf::Vec2 tangent = wf::perpCCW(info.normal);
-			float fNumerator = glm::dot(relVel, tangent) * m_friction;
-			float f = fNumerator / jDenom;
+			pts.setInsideAnother(i);
+			hit = true;
+		}
 
-			if (relDot < 0.0001f) {
-				if (!pointAFixed) {
-					pointA.velocity += wf::Vec3((info.normal * (j / pointA.mass)) - (tangent * (f / pointA.mass)), 0.f);
-				}
+		if (hit) body.colliding = true;
 
-				if (!pointB1Fixed) {
-					pointB1.velocity -= wf::Vec3((info.normal * (j / b2MassSum) * b1inf) - (tangent * (f / b2MassSum) * b1inf), 0.f);
-				}
+		return hit;
+	}
 
-				if (!pointB2Fixed) {
-					pointB2.velocity -= wf::Vec3((info.normal * (j / b2MassSum) * b2inf) - (tangent * (f / b2MassSum) * b2inf), 0.f);
-				}
+	bool Collider::collideParticle(const wf::Vec2& from, wf::Vec2& to, float mass, float dt, Component::SoftBody& body) const
+	{
+		const auto& box = body.boundingBox;
+		if (!box.isValid || to.x < box.min.x || to.x > box.max.x || to.y < box.min.y || to.y > box.max.y) return false;
+		if (!body.edgeTree.containsPoint(to, body.edges)) return false;
+
+		// the way it's travelling stands in for a point's normal, so it goes back out the way it came in
+		EdgeKernels::Closest edge = findEdge(body.edges, body.edgeTree, to, to - from, SIZE_MAX);
+		if (!edge.found() || edge.distSq > m_penetrationThreshold * m_penetrationThreshold) return false;
+
+		auto& pts = body.points;
+		const size_t b1 = edge.edge;
+		const size_t b2 = (edge.edge + 1) % pts.size();
+		const wf::Vec2 normal = body.edges.getNormal(edge.edge);
+
+		bool pointB1Fixed = pts.isFixed(b1) || pts.getMass(b1) == 0.f || !body.isActive();
+		bool pointB2Fixed = pts.isFixed(b2) || pts.getMass(b2) == 0.f || !body.isActive();
+
+		float bMassSum = (pointB1Fixed || pointB2Fixed) ? std::numeric_limits<float>::infinity() : (pts.getMass(b1) + pts.getMass(b2));
+		float penetration = sqrt(edge.distSq) + 0.001f;
+
+		// how fast it was going into the edge, before we move anything
+		wf::Vec2 edgeVel = std::isinf(bMassSum) ? wf::Vec2{} : wf::Vec2{ pts.velX[b1] + pts.velX[b2], pts.velY[b1] + pts.velY[b2] } * .5f;
+		float relDot = glm::dot((to - from) / dt - edgeVel, normal);
+
+		if (std::isinf(bMassSum)) {
+			to += normal * penetration;
+			return true;
+		}
+
+		float particleMove = penetration * (bMassSum / (mass + bMassSum));
+		float bodyMove = penetration - particleMove;
+
+		to += normal * particleMove;
+		pts.movePosition(b1, -wf::Vec3(normal * (bodyMove * (1.f - edge.edgeD)), 0.f));
+		pts.movePosition(b2, -wf::Vec3(normal * (bodyMove * edge.edgeD), 0.f));
+
+		// the particle's velocity comes from where it ends up, so it's already stopped going in. the edge gets the rest
+		if (relDot < 0.f) {
+			float j = -relDot / (1.f / mass + 1.f / bMassSum);
+			wf::Vec2 dv = normal * (-j / bMassSum);
+
+			pts.velX[b1] += dv.x;
+			pts.velY[b1] += dv.y;
+			pts.velX[b2] += dv.x;
+			pts.velY[b2] += dv.y;
+		}
+
+		return true;
+	}
+
+	bool Collider::collideParticle(const wf::Vec2& from, wf::Vec2& to, const Component::StaticCollider& fixture) const
+	{
+		const auto& edges = fixture.edges;
+
+		if (fixture.closed) {
+			if (!fixture.boundingBox.contains(wf::Vec3{ to, 0.f })) return false;
+			if (!fixture.edgeTree.containsPoint(to, edges)) return false;
+
+			EdgeKernels::Closest edge = findEdge(edges, fixture.edgeTree, to, to - from, SIZE_MAX);
+			if (!edge.found() || edge.distSq > m_penetrationThreshold * m_penetrationThreshold) return false;
+
+			to += edges.getNormal(edge.edge) * (sqrt(edge.distSq) + 0.001f);
+			return true;
+		}
+
+		float hitT = 1.f;
+		size_t hitEdge = firstCrossing(edges, fixture.edgeTree, from, to, hitT);
+		if (hitEdge == SIZE_MAX) return false;
+
+		// back onto the open side, keeping any movement along the line
+		wf::Vec2 normal = edges.getNormal(hitEdge);
+		wf::Vec2 clamped = from + (to - from) * hitT;
+		to += normal * (glm::dot(clamped - to, normal) + m_sweepSkin);
+
+		return true;
+	}
+
+	bool Collider::collideHeightfield(Component::SoftBody& body, const wf::Heightfield& field) const
+	{
+		const auto& ground = field.getBounds();
+		if (!field.isValid() || body.boundingBox.min.y > ground.max.y) {
+			return false;
+		}
+
+		auto& pts = body.points;
+		bool hit = false;
+
+		for (size_t i = 0; i < pts.size(); i++) {
+			if (pts.isFixed(i)) continue;
+
+			float height = field.getHeight(pts.posX[i], pts.posZ[i]);
+			if (pts.posY[i] >= height) continue;
+
+			// straight up rather than along the normal, so the point doesn't slide into a different cell on the way out
+			pts.posY[i] = height + m_sweepSkin;
+
+			// the slope as seen in the plane the bodies live in; z only matters for where it's sampled
+			wf::Vec3 normal = field.getNormal(pts.posX[i], pts.posZ[i]);
+			wf::Vec2 normal2 = { normal.x, normal.y };
+			float len = glm::length(normal2);
+			bounceStatic(pts, i, len > EPSILON ? normal2 / len : wf::Vec2{ 0.f, 1.f });
+
+			pts.setInsideAnother(i);
+			hit = true;
+		}
+
+		if (hit) body.colliding = true;
+
+		return hit;
+	}
+
+	void Collider::add(const std::vector<CollisionData>& collisions)
+	{
+		for (const auto& info : collisions) {
+			info.obj1->points.setInsideAnother(info.obj1Point);
+			info.obj1->colliding = true;
+			m_collisions.push_back(info);
+		}
+	}
+
+	void Collider::respond()
+	{
+		for (const auto& info : m_collisions) {
+			resolve(info);
+		}
+	}
+
+	void Collider::respond(wf::ThreadPool& pool, size_t bodyCount)
+	{
+		// with one thread the islands buy nothing, and going through the queue in order gives the same answer
+		if (pool.getThreadCount() == 1) {
+			respond();
+			return;
+		}
+
+		// bodies that can move and touch each other have to be resolved together, in order. bodies that can't move are
+		// never written to, so they don't link anything.
+		m_islands.reset(bodyCount);
+
+		for (const auto& info : m_collisions) {
+			if (info.obj1->isActive() && info.obj2->isActive()) {
+				m_islands.join(info.obj1->solverIndex, info.obj2->solverIndex);
 			}
 		}
+
+		size_t islandCount = m_islands.build();
+
+		// bucket the contacts by island, keeping their order within each
+		m_islandStart.assign(islandCount + 1, 0);
+		m_islandContacts.resize(m_collisions.size());
+
+		auto islandOf = [&](const CollisionData& info) -> int64_t {
+			if (info.obj1->isActive()) return m_islands.getIsland(info.obj1->solverIndex);
+			if (info.obj2->isActive()) return m_islands.getIsland(info.obj2->solverIndex);
+			return -1;
+		};
+
+		for (const auto& info : m_collisions) {
+			int64_t island = islandOf(info);
+			if (island >= 0) m_islandStart[island + 1]++;
+		}
+
+		for (size_t i = 0; i < islandCount; i++) {
+			m_islandStart[i + 1] += m_islandStart[i];
+		}
+
+		m_islandFill.assign(m_islandStart.begin(), m_islandStart.end() - 1);
+
+		for (size_t i = 0; i < m_collisions.size(); i++) {
+			int64_t island = islandOf(m_collisions[i]);
+			if (island >= 0) m_islandContacts[m_islandFill[island]++] = static_cast<uint32_t>(i);
+		}
+
+		// islands don't share anything that gets written, so they can go in any order, on any thread
+		pool.parallelFor(islandCount,
+			[&](size_t begin, size_t end) {
+				for (size_t island = begin; island < end; island++) {
+					for (uint32_t c = m_islandStart[island]; c < m_islandStart[island + 1]; c++) {
+						resolve(m_collisions[m_islandContacts[c]]);
+					}
+				}
+			});
 	}
 
-	EdgeCol Collider::getClosestPointOnEdgeSquared(const wf::Vec2& pt, const Component::Edge& edge)
+	void Collider::resolve(const CollisionData& info)
 	{
-		EdgeCol ret;
+		// @todo this was quite useful but maybe a better way now we know what we're doing a bit more...
+		/*if (NotifyCollision(info)) {
+			return;
+		}*/
+
+		auto& ptsA = info.obj1->points;
+		auto& ptsB = info.obj2->points;
+
+		const size_t a = info.obj1Point;
+		const size_t b1 = info.obj2PointA;
+		const size_t b2 = info.obj2PointB;
+
+		const float massA = ptsA.getMass(a);
+		const float massB1 = ptsB.getMass(b1);
+		const float massB2 = ptsB.getMass(b2);
+
+		// sleeping bodies hold still like fixed ones; anything that should move them will have woken them already
+		bool pointAFixed = ptsA.isFixed(a) || massA == 0.f || !info.obj1->isActive();
+		bool pointB1Fixed = ptsB.isFixed(b1) || massB1 == 0.f || !info.obj2->isActive();
+		bool pointB2Fixed = ptsB.isFixed(b2) || massB2 == 0.f || !info.obj2->isActive();
+
+		// fixme doing this also for kinematics, but this might be better to use derivedVelocity...if we calc it for kinematic objects.
+		wf::Vec2 velA = { ptsA.velX[a], ptsA.velY[a] };
+		wf::Vec2 velB1 = pointB1Fixed ? wf::Vec2{} : wf::Vec2{ ptsB.velX[b1], ptsB.velY[b1] };
+		wf::Vec2 velB2 = pointB2Fixed ? wf::Vec2{} : wf::Vec2{ ptsB.velX[b2], ptsB.velY[b2] };
+		wf::Vec2 bVel = (velB1 + velB2) * .5f;
+		wf::Vec2 relVel = velA - bVel;
+		float relDot = glm::dot(relVel, info.normal);
+
+		// nothing to do if the points are moving away from eachother already @todo assess this
+		/*if (relDot >= 0.f) {
+			return;
+		}*/
+
+		if (info.penetrationSq > (m_penetrationThreshold * m_penetrationThreshold)) {
+			return;
+		}
+
+		float penetration = sqrt(info.penetrationSq);
+
+		float b1inf = 1.f - info.edgeD;
+		float b2inf = info.edgeD;
 
-		wf::Vec2 toP = pt - wf::Vec2(edge.p1);
+		float b2MassSum = (pointB1Fixed || pointB2Fixed) ? std::numeric_limits<float>::infinity() : (massB1 + massB2);
+		float massSum = massA + b2MassSum;
 
-		wf::Vec2 n = wf::perpCCW(edge.dir);
-		float x = glm::dot(toP, wf::Vec2(edge.dir));
+		float Amove = 0.f;
+		float Bmove = 0.f;
 
-		if (x <= 0.f) {
-			ret.dist = glm::length2(pt - wf::Vec2(edge.p1));
-			ret.hitPoint = edge.p1;
-			ret.edgeD = 0.f;
-			ret.normal = n;
+		if (pointAFixed) {
+			Bmove = penetration + 0.001f;
 		}
-		else if (x >= edge.length) {
-			ret.dist = glm::length2(pt - wf::Vec2(edge.p2));
-			ret.hitPoint = edge.p2;
-			ret.edgeD = 1.f;
-			ret.normal = n;
+		else if (std::isinf(b2MassSum)) {
+			Amove = penetration + 0.001f;
 		}
 		else {
-			ret.dist = wf::cross2D(toP, wf::Vec2(edge.dir));
-			ret.dist *= ret.dist;
-			ret.hitPoint = edge.p1 + (edge.dir * x);
-			ret.edgeD = x / edge.length;
-			ret.normal = n;
+			Amove = (penetration * (b2MassSum / massSum));
+			Bmove = (penetration * (massA / massSum));
+		}
+
+		float pointB1move = Bmove * b1inf;
+		float pointB2move = Bmove * b2inf;
+
+		float AinvMass = pointAFixed ? 0.f : 1.f / massA;
+		float BinvMass = std::isinf(b2MassSum) ? 0.f : 1.f / b2MassSum;
+
+		float jDenom = AinvMass + BinvMass;
+		wf::Vec2 numV = relVel * (1.f + m_elasticity);
+
+		float jNumerator = glm::dot(numV, info.normal);
+		jNumerator = -jNumerator;
+
+		float j = jNumerator / jDenom;
+
+		if (!pointAFixed) {
+			ptsA.movePosition(a, wf::Vec3(info.normal * Amove, 0.f));
+		}
+
+		if (!pointB1Fixed) {
+			ptsB.movePosition(b1, -wf::Vec3(info.normal * pointB1move, 0.f));
+		}
+
+		if (!pointB2Fixed) {
+			ptsB.movePosition(b2, -wf::Vec3(info.normal * pointB2move, 0.f));
 		}
 
-		return ret;
+		wf::Vec2 tangent = wf::perpCCW(info.normal);
+		float fNumerator = glm::dot(relVel, tangent) * m_friction;
+		float f = fNumerator / jDenom;
+
+		if (relDot < 0.0001f) {
+			if (!pointAFixed) {
+				ptsA.addVelocity(a, wf::Vec3((info.normal * (j / massA)) - (tangent * (f / massA)), 0.f));
+			}
+
+			if (!pointB1Fixed) {
+				ptsB.addVelocity(b1, -wf::Vec3((info.normal * (j / b2MassSum) * b1inf) - (tangent * (f / b2MassSum) * b1inf), 0.f));
+			}
+
+			if (!pointB2Fixed) {
+				ptsB.addVelocity(b2, -wf::Vec3((info.normal * (j / b2MassSum) * b2inf) - (tangent * (f / b2MassSum) * b2inf), 0.f));
+			}
+		}
 	}
 
-	bool Collider::checkCollisionPoint(const wf::Vec2 point, const std::vector<Component::PointMass>& points)
+	EdgeKernels::Closest Collider::findEdge(const Component::EdgeList& edges, const EdgeBVH& tree, const wf::Vec2& pt, const wf::Vec2& ptNorm, size_t seed) const
 	{
-		bool inside = false;
-
-		if (points.size() > 2) {
-			for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
-				if (
-					(points[i].position.y > point.y) != (points[j].position.y > point.y) &&
-					(point.x < (points[j].position.x - points[i].position.x) * (point.y - points[i].position.y) / (points[j].position.y - points[i].position.y) + points[i].position.x)
-					) {
-					inside = !inside;
-				}
+		EdgeKernels::Closest away;
+		EdgeKernels::Closest same;
+
+		// a seed and its neighbours get the bound down early. the search below settles ties the same way whatever it
+		// starts with, so this only saves work
+		const size_t edgeCount = edges.size();
+		if (seed < edgeCount) {
+			for (size_t e : { seed, (seed + 1) % edgeCount, (seed + edgeCount - 1) % edgeCount }) {
+				EdgeKernels::findClosest(edges, e, 1, pt, ptNorm, away, same);
 			}
 		}
-		return inside;
+
+		// walk the edge tree nearest first, skipping anything that couldn't change which edge gets picked below: once
+		// something faces away, nothing further than it. until then, same-facing edges or away-facing ones that would
+		// still win for being within the threshold
+		tree.nearest(pt,
+			[&](uint32_t first, uint32_t count) {
+				EdgeKernels::findClosest(edges, first, count, pt, ptNorm, away, same);
+			},
+			[&]() { return away.found() ? away.distSq : std::max(same.distSq, m_penetrationThreshold); });
+
+		// prefer the edge facing away, unless it's too deep and a same-facing one is closer. if nothing faced away at
+		// all, the same-facing one is all we have
+		bool useSame = !away.found() || ((away.distSq > m_penetrationThreshold) && (same.distSq < away.distSq));
+		return useSame ? same : away;
+	}
+
+	size_t Collider::firstCrossing(const Component::EdgeList& edges, const EdgeBVH& tree, const wf::Vec2& from, const wf::Vec2& to, float& hitT)
+	{
+		wf::Vec2 path = to - from;
+		if (glm::length2(path) < 1e-8f) return SIZE_MAX;
+
+		size_t hitEdge = SIZE_MAX;
+
+		tree.overlapping(glm::min(from, to), glm::max(from, to),
+			[&](uint32_t first, uint32_t count) {
+				for (uint32_t e = first; e < first + count; e++) {
+					// only on the way in
+					wf::Vec2 normal = edges.getNormal(e);
+					if (glm::dot(path, normal) >= 0.f) continue;
+
+					wf::Vec2 p1 = edges.getP1(e);
+					wf::Vec2 edge = edges.getP2(e) - p1;
+
+					float denom = wf::cross2D(path, edge);
+					if (std::abs(denom) < 1e-12f) continue;
+
+					wf::Vec2 toEdge = p1 - from;
+					float t = wf::cross2D(toEdge, edge) / denom;
+					float u = wf::cross2D(toEdge, path) / denom;
+
+					if (t < 0.f || t > hitT || u < 0.f || u > 1.f) continue;
+					if (t == hitT && e > hitEdge) continue;
+
+					hitT = t;
+					hitEdge = e;
+				}
+			});
+
+		return hitEdge;
+	}
+
+	void Collider::resolveStatic(Component::PointMasses& pts, size_t i, const wf::Vec2& normal, float push) const
+	{
+		// the same response as against a fixed body, where the other side has no velocity and infinite mass
+		pts.posX[i] += normal.x * push;
+		pts.posY[i] += normal.y * push;
+
+		bounceStatic(pts, i, normal);
+	}
+
+	void Collider::bounceStatic(Component::PointMasses& pts, size_t i, const wf::Vec2& normal) const
+	{
+		wf::Vec2 vel = { pts.velX[i], pts.velY[i] };
+		float relDot = glm::dot(vel, normal);
+
+		if (relDot < 0.0001f) {
+			wf::Vec2 tangent = wf::perpCCW(normal);
+			vel += normal * (-(1.f + m_elasticity) * relDot) - tangent * (glm::dot(vel, tangent) * m_friction);
+
+			pts.velX[i] = vel.x;
+			pts.velY[i] = vel.y;
+		}
+	}
+
+	CollisionData Collider::makeCollision(Component::SoftBody& obj1, size_t point, Component::SoftBody& obj2, const EdgeKernels::Closest& edge)
+	{
+		CollisionData info;
+		info.clear();
+		info.obj1 = &obj1;
+		info.obj1Point = point;
+		info.obj2 = &obj2;
+
+		info.obj2PointA = edge.edge;
+		info.obj2PointB = (edge.edge + 1) % obj2.points.size();
+		info.edgeD = edge.edgeD;
+		info.hitPoint = edge.hitPoint;
+		info.normal = obj2.edges.getNormal(edge.edge);
+		info.penetrationSq = edge.distSq;
+
+		return info;
 	}
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 #pragma once
 #include "Engine.h"
 #include "Component/SoftBodyComponent.h"
+#include "Component/RigidBodyComponent.h"
+#include "Component/StaticColliderComponent.h"
+#include "Utils/EdgeKernels.h"
+#include "Utils/Islands.h"
 
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -11,20 +18,14 @@
  */
 namespace Squishies
 {
-	struct EdgeCol
-	{
-		wf::Vec2 hitPoint{};
-		wf::Vec2 normal{};
-		float edgeD{};
-		float dist{};
-	};
-
 	struct CollisionData
 	{
 		Component::SoftBody* obj1{ nullptr };
+		wf::EntityID obj1Id{ entt::null };
 		size_t obj1Point{};
 
 		Component::SoftBody* obj2{ nullptr };
+		wf::EntityID obj2Id{ entt::null };
 		size_t obj2PointA{};
 		size_t obj2PointB{};
 
@@ -36,6 +37,7 @@ namespace Squishies
 		void clear()
 		{
 			obj1 = obj2 = nullptr;
+			obj1Id = obj2Id = entt::null;
 			obj1Point = obj2PointA = obj2PointB = -1;
 			hitPoint = normal = {};
 			edgeD = penetrationSq = 0.0f;
@@ -57,35 +59,151 @@ namespace Squishies
 		void setup(float penetrationThreshold, float elasticity, float friction);
 
 		/**
-		 * @brief Clear out all previous data
+		 * @brief Clear out all previous data, keeping where everything was touching in the contact cache
 		 */
 		void reset();
 
 		/**
-		 * @brief Determine if we've had a collision and updates data about it
+		 * @brief Determine if any points of obj1 have gone inside obj2, gathering the details into `out`.
+		 *
+		 * Neither body is modified, so pairs can be checked from several threads at once as long as each has its own
+		 * output. Feed the results to add() once they've all been gathered. Points that were in contact last step start
+		 * their edge search from the edge they hit then.
+		 * @param id1
 		 * @param obj1
+		 * @param id2
 		 * @param obj2
+		 * @param out
 		 * @return
 		 */
-		bool check(Component::SoftBody& obj1, Component::SoftBody& obj2);
+		bool check(wf::EntityID id1, Component::SoftBody& obj1, wf::EntityID id2, Component::SoftBody& obj2, std::vector<CollisionData>& out) const;
+
+		/**
+		 * @brief Continuous check for a fast body: pull back any point of `fast` whose path this step (from its last
+		 * position) entered `other` through an edge, to just inside that edge at the earliest impact.
+		 *
+		 * `other` is taken to be where it is now for the whole step. The clamped points are then caught by check() like
+		 * any other, rather than having tunnelled through. Returns whether anything was moved.
+		 */
+		bool sweep(Component::SoftBody& fast, const Component::SoftBody& other) const;
+
+		/**
+		 * @brief Push any points of the body out of a piece of static geometry, and bounce them off it.
+		 *
+		 * Static geometry never moves, so this resolves straight away rather than queueing anything up, and different
+		 * bodies can be done on different threads. Returns whether anything was touching.
+		 */
+		bool collideStatic(Component::SoftBody& body, const Component::StaticCollider& fixture) const;
+
+		/**
+		 * @brief Lift any points of the body that are below the ground back onto it, and bounce them off the slope there.
+		 *
+		 * Like collideStatic() this resolves straight away and is safe to run for different bodies at once. Returns whether
+		 * anything was touching.
+		 */
+		bool collideHeightfield(Component::SoftBody& body, const wf::Heightfield& field) const;
+
+		/**
+		 * @brief Push any points of the body out of a rigid body's outline, and trade impulses with it.
+		 *
+		 * Only the soft body is changed here. What the rigid body gets back is added to linearImpulse and angularImpulse
+		 * (about its centre of mass), for the caller to hand on to Bullet. Returns whether anything was touching.
+		 */
+		bool collideRigid(Component::SoftBody& body, const Component::RigidBody& rigid, wf::Vec2& linearImpulse, float& angularImpulse) const;
+
+		/**
+		 * @brief Push a liquid particle moving from `from` to `to` back out of a body, sharing the push with the edge's
+		 * points by mass the way respond() would for a point of another body. Returns whether it was inside.
+		 *
+		 * The edge also takes whatever momentum the particle carried into it, so liquid can shove bodies about. Sleeping
+		 * bodies hold still. Not safe to call for the same body from more than one thread at once.
+		 */
+		bool collideParticle(const wf::Vec2& from, wf::Vec2& to, float mass, float dt, Component::SoftBody& body) const;
+
+		/**
+		 * @brief Push a liquid particle moving from `from` to `to` back out of, or off of, a piece of static geometry
+		 */
+		bool collideParticle(const wf::Vec2& from, wf::Vec2& to, const Component::StaticCollider& fixture) const;
+
+		/**
+		 * @brief Queue up collisions found by check(), marking the points and bodies involved as colliding
+		 */
+		void add(const std::vector<CollisionData>& collisions);
 
 		/**
 		 * @brief Process all of the collisions we detected
 		 */
 		void respond();
 
+		/**
+		 * @brief Process all of the collisions we detected, spreading independent islands of contacts over the pool.
+		 *
+		 * Contacts are grouped by which moving bodies they link (by solverIndex, which must be below bodyCount), and
+		 * each group is resolved in the order it was added, so the result matches respond() exactly. A pool with only the
+		 * one thread just uses respond().
+		 */
+		void respond(wf::ThreadPool& pool, size_t bodyCount);
+
+		/**
+		 * @brief Everything queued up by add() since the last reset
+		 */
+		const std::vector<CollisionData>& getCollisions() const { return m_collisions; }
+
+		/**
+		 * @brief Earliest edge crossed on the way in by a point moving from `from` to `to`, or SIZE_MAX. hitT is how far along,
+		 * and only anything nearer than it going in counts
+		 */
+		static size_t firstCrossing(const Component::EdgeList& edges, const EdgeBVH& tree, const wf::Vec2& from, const wf::Vec2& to, float& hitT);
+
 	private:
-		EdgeCol getClosestPointOnEdgeSquared(const wf::Vec2& pt, const Component::Edge& edge);
-		bool checkCollisionPoint(const wf::Vec2 point, const std::vector<Component::PointMass>& points);
+		/**
+		 * @brief A point against another body, last step
+		 */
+		struct ContactKey
+		{
+			wf::EntityID body{};
+			uint32_t point{};
+			wf::EntityID other{};
+
+			bool operator==(const ContactKey&) const = default;
+		};
+
+		struct ContactKeyHash
+		{
+			size_t operator()(const ContactKey& key) const
+			{
+				uint64_t bodies = (static_cast<uint64_t>(key.body) << 32) | static_cast<uint64_t>(key.other);
+				return std::hash<uint64_t>{}(bodies ^ (static_cast<uint64_t>(key.point) * 0x9E3779B97F4A7C15ull));
+			}
+		};
+
+		void resolve(const CollisionData& info);
+		void resolveStatic(Component::PointMasses& pts, size_t i, const wf::Vec2& normal, float push) const;
+		void bounceStatic(Component::PointMasses& pts, size_t i, const wf::Vec2& normal) const;
+
+		/**
+		 * @brief Pick the edge a point inside the outline should be pushed out through. seed (or SIZE_MAX) is a likely answer
+		 */
+		EdgeKernels::Closest findEdge(const Component::EdgeList& edges, const EdgeBVH& tree, const wf::Vec2& pt, const wf::Vec2& ptNorm, size_t seed) const;
+
+		static CollisionData makeCollision(Component::SoftBody& obj1, size_t point, Component::SoftBody& obj2, const EdgeKernels::Closest& edge);
 
 	private:
 		wf::EventDispatcher* m_eventDispatcher{ nullptr };
 
 		std::vector<CollisionData> m_collisions;
+		std::unordered_map<ContactKey, uint32_t, ContactKeyHash> m_contactCache;		// last step's contacts, to the edge hit
+
+		// response islands
+		IslandBuilder m_islands;
+		std::vector<uint32_t> m_islandStart;					// where each island's contacts begin in m_islandContacts
+		std::vector<uint32_t> m_islandFill;
+		std::vector<uint32_t> m_islandContacts;					// contact indices, grouped by island
 
 		// config
 		float m_penetrationThreshold{ .3f };
 		float m_elasticity{ .8f };
 		float m_friction{ .3f };
+		float m_sweepSkin{ .005f };									// how far past the edge a swept point is left
 	};
 }
\ No newline at end of file
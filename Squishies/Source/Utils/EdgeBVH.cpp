@@ -0,0 +1,113 @@
+#include "EdgeBVH.h"
+
+#include <algorithm>
+
+namespace Squishies
+{
+	void EdgeBVH::build(const Component::EdgeList& edges)
+	{
+		m_nodes.clear();
+		m_edgeCount = edges.size();
+
+		if (edges.empty()) return;
+
+		// a balanced binary tree over n edges has at most 2 * ceil(n / LEAF_SIZE) - 1 nodes
+		m_nodes.reserve(2 * ((m_edgeCount + LEAF_SIZE - 1) / LEAF_SIZE));
+		buildRange(0, static_cast<uint32_t>(m_edgeCount));
+
+		refit(edges);
+	}
+
+	void EdgeBVH::refit(const Component::EdgeList& edges)
+	{
+		if (edges.size() != m_edgeCount) {
+			build(edges);
+			return;
+		}
+
+		// children always come after their parent, so walking backwards is bottom-up
+		for (size_t i = m_nodes.size(); i-- > 0;) {
+			Node& node = m_nodes[i];
+
+			if (node.count) {
+				fitLeaf(node, edges);
+				continue;
+			}
+
+			const Node& left = m_nodes[i + 1];
+			const Node& right = m_nodes[node.first];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+		}
+	}
+
+	bool EdgeBVH::containsPoint(const wf::Vec2& pt, const Component::EdgeList& edges) const
+	{
+		if (m_nodes.empty() || edges.size() < 3) return false;
+
+		uint32_t crossings = 0;
+
+		uint32_t stack[64];
+		int top = 0;
+		stack[top++] = 0;
+
+		while (top > 0) {
+			const Node& node = m_nodes[stack[--top]];
+
+			// an edge can only cross the ray if it straddles our y, and the crossing can't be further right than the box
+			if (node.max.y <= pt.y || node.min.y > pt.y || pt.x >= node.max.x) continue;
+
+			if (!node.count) {
+				stack[top++] = node.first;
+				stack[top++] = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+				continue;
+			}
+
+			crossings += EdgeKernels::countCrossings(edges, node.first, node.count, pt);
+		}
+
+		return crossings & 1;
+	}
+
+	uint32_t EdgeBVH::buildRange(uint32_t first, uint32_t count)
+	{
+		uint32_t index = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.emplace_back();
+
+		if (count <= LEAF_SIZE) {
+			m_nodes[index].first = first;
+			m_nodes[index].count = count;
+			return index;
+		}
+
+		// halve the run; the left child goes straight after us
+		uint32_t half = count / 2;
+		buildRange(first, half);
+		uint32_t right = buildRange(first + half, count - half);
+
+		m_nodes[index].first = right;
+		m_nodes[index].count = 0;
+
+		return index;
+	}
+
+	void EdgeBVH::fitLeaf(Node& node, const Component::EdgeList& edges)
+	{
+		node.min = wf::Vec2(FLT_MAX);
+		node.max = wf::Vec2(-FLT_MAX);
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++) {
+			wf::Vec2 p1 = edges.getP1(i);
+			wf::Vec2 p2 = edges.getP2(i);
+
+			node.min = glm::min(node.min, glm::min(p1, p2));
+			node.max = glm::max(node.max, glm::max(p1, p2));
+		}
+	}
+
+	float EdgeBVH::distanceSquared(const Node& node, const wf::Vec2& pt)
+	{
+		wf::Vec2 d = glm::max(glm::max(node.min - pt, pt - node.max), wf::Vec2(0.f));
+		return glm::dot(d, d);
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "Engine.h"
+#include "Component/EdgeList.h"
+#include "Utils/EdgeKernels.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Squishies
+{
+	/**
+	 * @brief Bounding volume hierarchy over the edges of a soft body outline (2D, XY).
+	 *
+	 * Edges around an outline are spatially coherent in index order, so the tree just halves the index range at each
+	 * level. That keeps it balanced, means leaves cover contiguous runs of edges (no index indirection), and lets the
+	 * topology stay put while the body deforms; only the boxes need refitting. Nodes are stored depth first, so children
+	 * always come after their parent and a reverse walk refits bottom-up.
+	 */
+	class EdgeBVH
+	{
+	public:
+		static constexpr uint32_t LEAF_SIZE = EdgeKernels::WIDTH > 4 ? EdgeKernels::WIDTH : 4;	// max edges per leaf; at least one kernel pass
+
+		struct Node
+		{
+			wf::Vec2 min{};
+			wf::Vec2 max{};
+			uint32_t first{ 0 };									// leaf: first edge. internal: index of the right child (left is next)
+			uint32_t count{ 0 };									// leaf: number of edges. internal: 0
+		};
+
+		/**
+		 * @brief Build the tree topology and boxes for the given edges
+		 */
+		void build(const Component::EdgeList& edges);
+
+		/**
+		 * @brief Refit the boxes to where the edges are now. Rebuilds if the edge count has changed
+		 */
+		void refit(const Component::EdgeList& edges);
+
+		/**
+		 * @brief Crossing number point-in-polygon test, skipping any part of the outline that can't cross the ray
+		 */
+		bool containsPoint(const wf::Vec2& pt, const Component::EdgeList& edges) const;
+
+		/**
+		 * @brief Visit leaves nearest first, skipping nodes further away than the current bound.
+		 *
+		 * leafFn(first, count) is given each run of edges to test; bound() returns the squared distance beyond which
+		 * nothing is of interest any more, and is re-read as the search tightens it.
+		 */
+		template<typename LeafFn, typename BoundFn>
+		void nearest(const wf::Vec2& pt, LeafFn&& leafFn, BoundFn&& bound) const;
+
+		/**
+		 * @brief Visit every leaf whose box overlaps the given box, as leafFn(first, count)
+		 */
+		template<typename LeafFn>
+		void overlapping(const wf::Vec2& min, const wf::Vec2& max, LeafFn&& leafFn) const;
+
+		bool empty() const { return m_nodes.empty(); }
+		size_t edgeCount() const { return m_edgeCount; }
+		const std::vector<Node>& getNodes() const { return m_nodes; }
+
+	private:
+		uint32_t buildRange(uint32_t first, uint32_t count);
+		void fitLeaf(Node& node, const Component::EdgeList& edges);
+		static float distanceSquared(const Node& node, const wf::Vec2& pt);
+
+	private:
+		std::vector<Node> m_nodes;
+		size_t m_edgeCount{ 0 };
+	};
+
+	template<typename LeafFn, typename BoundFn>
+	inline void EdgeBVH::nearest(const wf::Vec2& pt, LeafFn&& leafFn, BoundFn&& bound) const
+	{
+		if (m_nodes.empty()) return;
+
+		// the tree is balanced, so this is far deeper than we'll ever need
+		uint32_t stack[64];
+		float stackDist[64];
+		int top = 0;
+
+		stack[top] = 0;
+		stackDist[top++] = distanceSquared(m_nodes[0], pt);
+
+		while (top > 0) {
+			top--;
+			uint32_t index = stack[top];
+
+			// a little slack so rounding in the edge distance can't make us skip a tie
+			if (stackDist[top] * .9999f > bound()) continue;
+
+			const Node& node = m_nodes[index];
+
+			if (node.count) {
+				leafFn(node.first, node.count);
+				continue;
+			}
+
+			uint32_t left = index + 1;
+			uint32_t right = node.first;
+			float leftDist = distanceSquared(m_nodes[left], pt);
+			float rightDist = distanceSquared(m_nodes[right], pt);
+
+			// push the further one first so the nearer is visited first
+			if (leftDist <= rightDist) {
+				stack[top] = right; stackDist[top++] = rightDist;
+				stack[top] = left; stackDist[top++] = leftDist;
+			}
+			else {
+				stack[top] = left; stackDist[top++] = leftDist;
+				stack[top] = right; stackDist[top++] = rightDist;
+			}
+		}
+	}
+
+	template<typename LeafFn>
+	inline void EdgeBVH::overlapping(const wf::Vec2& min, const wf::Vec2& max, LeafFn&& leafFn) const
+	{
+		if (m_nodes.empty()) return;
+
+		uint32_t stack[64];
+		int top = 0;
+		stack[top++] = 0;
+
+		while (top > 0) {
+			uint32_t index = stack[--top];
+			const Node& node = m_nodes[index];
+
+			if (node.max.x < min.x || node.min.x > max.x || node.max.y < min.y || node.min.y > max.y) continue;
+
+			if (node.count) {
+				leafFn(node.first, node.count);
+				continue;
+			}
+
+			stack[top++] = node.first;
+			stack[top++] = index + 1;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#include "EdgeKernels.h"
+
+#include "Utils/Lanes.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Squishies::EdgeKernels
+{
+	namespace
+	{
+		constexpr uint32_t laneMask(size_t remaining)
+		{
+			return remaining >= WIDTH ? (1u << WIDTH) - 1u : (1u << remaining) - 1u;
+		}
+
+		void consider(Closest& best, float dist, size_t edge, float edgeD, const wf::Vec2& hitPoint)
+		{
+			if (dist < best.distSq || (dist == best.distSq && edge < best.edge)) {
+				best.distSq = dist;
+				best.edge = edge;
+				best.edgeD = edgeD;
+				best.hitPoint = hitPoint;
+			}
+		}
+	}
+
+	uint32_t countCrossings(const Component::EdgeList& edges, size_t first, size_t count, const wf::Vec2& pt)
+	{
+		using L = Lanes;
+
+		const L::V px = L::set(pt.x);
+		const L::V py = L::set(pt.y);
+
+		uint32_t crossings = 0;
+		const size_t last = first + count;
+
+		for (size_t i = first; i < last; i += WIDTH) {
+			L::V ax = L::load(&edges.p1X[i]);
+			L::V ay = L::load(&edges.p1Y[i]);
+			L::V bx = L::load(&edges.p2X[i]);
+			L::V by = L::load(&edges.p2Y[i]);
+
+			// the edge straddles our y, and crosses it to the right of us. lanes that don't straddle may divide by
+			// zero, but they're masked off anyway.
+			L::V straddles = L::maskXor(L::gt(ay, py), L::gt(by, py));
+			L::V crossX = L::add(L::div(L::mul(L::sub(bx, ax), L::sub(py, ay)), L::sub(by, ay)), ax);
+			L::V hit = L::maskAnd(straddles, L::lt(px, crossX));
+
+			crossings += std::popcount(L::bits(hit) & laneMask(last - i));
+		}
+
+		return crossings;
+	}
+
+	void findClosest(const Component::EdgeList& edges, size_t first, size_t count, const wf::Vec2& pt, const wf::Vec2& ptNorm, Closest& away, Closest& same)
+	{
+		using L = Lanes;
+
+		const L::V px = L::set(pt.x);
+		const L::V py = L::set(pt.y);
+		const L::V nx = L::set(ptNorm.x);
+		const L::V ny = L::set(ptNorm.y);
+		const L::V zero = L::set(0.f);
+		const L::V one = L::set(1.f);
+
+		alignas(32) float dist[WIDTH];
+		alignas(32) float along[WIDTH];
+		alignas(32) float edgeD[WIDTH];
+
+		const size_t last = first + count;
+
+		for (size_t i = first; i < last; i += WIDTH) {
+			L::V ax = L::load(&edges.p1X[i]);
+			L::V ay = L::load(&edges.p1Y[i]);
+			L::V bx = L::load(&edges.p2X[i]);
+			L::V by = L::load(&edges.p2Y[i]);
+			L::V dx = L::load(&edges.dirX[i]);
+			L::V dy = L::load(&edges.dirY[i]);
+			L::V len = L::load(&edges.length[i]);
+
+			// project onto the edge
+			L::V tx = L::sub(px, ax);
+			L::V ty = L::sub(py, ay);
+			L::V x = L::add(L::mul(tx, dx), L::mul(ty, dy));
+
+			// squared distance to p1, to p2, and perpendicular to the edge; pick whichever the projection lands on
+			L::V toP1 = L::add(L::mul(tx, tx), L::mul(ty, ty));
+			L::V ux = L::sub(px, bx);
+			L::V uy = L::sub(py, by);
+			L::V toP2 = L::add(L::mul(ux, ux), L::mul(uy, uy));
+			L::V cross = L::sub(L::mul(tx, dy), L::mul(ty, dx));
+			L::V toLine = L::mul(cross, cross);
+
+			L::V beforeP1 = L::le(x, zero);
+			L::V pastP2 = L::ge(x, len);
+
+			L::store(dist, L::select(beforeP1, toP1, L::select(pastP2, toP2, toLine)));
+			L::store(edgeD, L::select(beforeP1, zero, L::select(pastP2, one, L::div(x, len))));
+			L::store(along, x);
+
+			// which way the edge faces compared to the point
+			L::V facing = L::add(L::mul(nx, L::load(&edges.normalX[i])), L::mul(ny, L::load(&edges.normalY[i])));
+			uint32_t awayBits = L::bits(L::le(facing, zero));
+
+			// fold the lanes into the bests in edge order
+			size_t lanes = std::min(WIDTH, last - i);
+			for (size_t lane = 0; lane < lanes; lane++) {
+				size_t e = i + lane;
+
+				Closest& best = (awayBits & (1u << lane)) ? away : same;
+				if (dist[lane] > best.distSq) continue;
+
+				wf::Vec2 hitPoint;
+				if (along[lane] <= 0.f) {
+					hitPoint = edges.getP1(e);
+				}
+				else if (along[lane] >= edges.length[e]) {
+					hitPoint = edges.getP2(e);
+				}
+				else {
+					hitPoint = edges.getP1(e) + edges.getDir(e) * along[lane];
+				}
+
+				consider(best, dist[lane], e, edgeD[lane], hitPoint);
+			}
+		}
+	}
+}
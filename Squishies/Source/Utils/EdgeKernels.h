@@ -0,0 +1,45 @@
+#pragma once
+#include "Engine.h"
+#include "Component/EdgeList.h"
+#include "Utils/Lanes.h"
+
+#include <cstdint>
+
+/**
+ * @brief Point-vs-edge kernels for the narrowphase.
+ *
+ * Each kernel tests one point against a run of edges from an EdgeList, a vector's worth at a time: 8 lanes with AVX2,
+ * 4 with SSE2, or one at a time as a scalar fallback. All paths do the same arithmetic in the same order per lane, so
+ * the results don't depend on which one was compiled in.
+ */
+namespace Squishies::EdgeKernels
+{
+	constexpr size_t WIDTH = Lanes::WIDTH;
+
+	/**
+	 * @brief Best edge found so far by findClosest()
+	 */
+	struct Closest
+	{
+		float distSq{ 100000.f };									// squared distance to the edge
+		size_t edge{ SIZE_MAX };									// edge index, or SIZE_MAX if nothing found yet
+		float edgeD{ 0.f };											// how far along the edge the closest point is, 0 - 1
+		wf::Vec2 hitPoint{};										// closest point on the edge
+
+		bool found() const { return edge != SIZE_MAX; }
+	};
+
+	/**
+	 * @brief Count how many of the edges [first, first + count) are crossed by a ray from pt along +X
+	 */
+	uint32_t countCrossings(const Component::EdgeList& edges, size_t first, size_t count, const wf::Vec2& pt);
+
+	/**
+	 * @brief Closest point on each of the edges [first, first + count), split by which way the edge faces.
+	 *
+	 * Edges whose normal faces away from ptNorm (dot <= 0) compete for `away`, the rest for `same`. Each only gets
+	 * replaced by something strictly closer, or equally close with a lower edge index, so the outcome doesn't depend on
+	 * the order runs are visited in.
+	 */
+	void findClosest(const Component::EdgeList& edges, size_t first, size_t count, const wf::Vec2& pt, const wf::Vec2& ptNorm, Closest& away, Closest& same);
+}
@@ -0,0 +1,54 @@
+#include "Islands.h"
+
+namespace Squishies
+{
+	void IslandBuilder::reset(size_t bodyCount)
+	{
+		m_parent.resize(bodyCount);
+		m_island.resize(bodyCount);
+		m_islandCount = 0;
+
+		for (uint32_t i = 0; i < bodyCount; i++) {
+			m_parent[i] = i;
+		}
+	}
+
+	void IslandBuilder::join(uint32_t a, uint32_t b)
+	{
+		a = find(a);
+		b = find(b);
+
+		if (a == b) return;
+
+		// lower index wins, which keeps things independent of join order
+		if (a < b) {
+			m_parent[b] = a;
+		}
+		else {
+			m_parent[a] = b;
+		}
+	}
+
+	size_t IslandBuilder::build()
+	{
+		m_islandCount = 0;
+
+		// roots are always the lowest body in their island, so they're seen before any of their members
+		for (uint32_t i = 0; i < m_parent.size(); i++) {
+			uint32_t root = find(i);
+			m_island[i] = (root == i) ? static_cast<uint32_t>(m_islandCount++) : m_island[root];
+		}
+
+		return m_islandCount;
+	}
+
+	uint32_t IslandBuilder::find(uint32_t body)
+	{
+		// path halving
+		while (m_parent[body] != body) {
+			m_parent[body] = m_parent[m_parent[body]];
+			body = m_parent[body];
+		}
+		return body;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Squishies
+{
+	/**
+	 * @brief Groups bodies into islands of things touching each other (union-find).
+	 *
+	 * Bodies are referred to by a dense index. The lower index always ends up as the root, and islands are numbered in
+	 * order of their lowest body, so the result only depends on which pairs were joined, not the order they came in.
+	 */
+	class IslandBuilder
+	{
+	public:
+		/**
+		 * @brief Start over with every body on its own
+		 */
+		void reset(size_t bodyCount);
+
+		/**
+		 * @brief Two bodies are touching
+		 */
+		void join(uint32_t a, uint32_t b);
+
+		/**
+		 * @brief Number the islands. Returns how many there are
+		 */
+		size_t build();
+
+		/**
+		 * @brief Which island a body ended up in, after build()
+		 */
+		uint32_t getIsland(uint32_t body) const { return m_island[body]; }
+		size_t getIslandCount() const { return m_islandCount; }
+
+	private:
+		uint32_t find(uint32_t body);
+
+	private:
+		std::vector<uint32_t> m_parent;
+		std::vector<uint32_t> m_island;
+		size_t m_islandCount{ 0 };
+	};
+}
@@ -0,0 +1,114 @@
+#include "JointKernels.h"
+
+#include <algorithm>
+
+namespace Squishies::JointKernels
+{
+	namespace
+	{
+		Lanes::V loadEnd(const float* base, const SpringEnd& end, size_t i)
+		{
+			return end.index ? Lanes::gather(base, &end.index[i]) : Lanes::load(&base[i]);
+		}
+
+		void scatter(const SpringEnd& end, size_t i, float sign, const float* fx, const float* fy, const float* fz, size_t lanes)
+		{
+			if (!end.points) return;
+
+			auto& pts = *end.points;
+			for (size_t lane = 0; lane < lanes; lane++) {
+				size_t p = end.index ? end.index[i + lane] : i + lane;
+				if (end.skipFixed && pts.isFixed(p)) continue;
+
+				pts.forceX[p] += sign * fx[lane];
+				pts.forceY[p] += sign * fy[lane];
+				pts.forceZ[p] += sign * fz[lane];
+			}
+		}
+	}
+
+	void accumulateSprings(size_t first, size_t count, const float* rest, const SpringEnd& a, const SpringEnd& b, float k, float damping)
+	{
+		using L = Lanes;
+
+		const L::V zero = L::set(0.f);
+		const L::V minDist = L::set(.01f);
+		const L::V vk = L::set(k);
+		const L::V vd = L::set(damping);
+
+		alignas(32) float fx[WIDTH];
+		alignas(32) float fy[WIDTH];
+		alignas(32) float fz[WIDTH];
+
+		const size_t last = first + count;
+
+		for (size_t i = first; i < last; i += WIDTH) {
+			L::V dx = L::sub(loadEnd(a.posX, a, i), loadEnd(b.posX, b, i));
+			L::V dy = L::sub(loadEnd(a.posY, a, i), loadEnd(b.posY, b, i));
+			L::V dz = L::sub(loadEnd(a.posZ, a, i), loadEnd(b.posZ, b, i));
+
+			// relative velocity; a still end contributes nothing
+			L::V rvx = zero, rvy = zero, rvz = zero;
+			if (a.velX) {
+				rvx = loadEnd(a.velX, a, i);
+				rvy = loadEnd(a.velY, a, i);
+				rvz = loadEnd(a.velZ, a, i);
+			}
+			if (b.velX) {
+				rvx = L::sub(rvx, loadEnd(b.velX, b, i));
+				rvy = L::sub(rvy, loadEnd(b.velY, b, i));
+				rvz = L::sub(rvz, loadEnd(b.velZ, b, i));
+			}
+
+			// ends on top of each other divide by zero here, but are masked off below
+			L::V dist = L::sqrt(L::add(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(dz, dz)));
+			L::V nx = L::div(dx, dist);
+			L::V ny = L::div(dy, dist);
+			L::V nz = L::div(dz, dist);
+
+			L::V stretch = L::sub(rest ? L::load(&rest[i]) : zero, dist);
+			L::V closing = L::add(L::add(L::mul(rvx, nx), L::mul(rvy, ny)), L::mul(rvz, nz));
+			L::V mag = L::sub(L::mul(stretch, vk), L::mul(closing, vd));
+			mag = L::select(L::lt(dist, minDist), zero, mag);
+
+			L::store(fx, L::mul(nx, mag));
+			L::store(fy, L::mul(ny, mag));
+			L::store(fz, L::mul(nz, mag));
+
+			// no point appears twice in the run, so the lanes can be added back in any order
+			size_t lanes = std::min(WIDTH, last - i);
+			scatter(a, i, 1.f, fx, fy, fz, lanes);
+			scatter(b, i, -1.f, fx, fy, fz, lanes);
+		}
+	}
+
+	void accumulateJoints(const Component::JointList& joints, Component::PointMasses& points, float k, float damping)
+	{
+		SpringEnd a{ joints.p1.data(), points.posX.data(), points.posY.data(), points.posZ.data(),
+			points.velX.data(), points.velY.data(), points.velZ.data(), &points, true };
+		SpringEnd b = a;
+		b.index = joints.p2.data();
+
+		for (size_t batch = 0; batch < joints.batchCount(); batch++) {
+			const size_t first = joints.batchStart[batch];
+			const size_t count = joints.batchStart[batch + 1] - first;
+			accumulateSprings(first, count, joints.rest.data(), a, b, k, damping);
+		}
+	}
+
+	void accumulateShapeMatch(Component::PointMasses& points, float k, float damping, bool stillTarget)
+	{
+		SpringEnd a{ nullptr, points.posX.data(), points.posY.data(), points.posZ.data(),
+			points.velX.data(), points.velY.data(), points.velZ.data(), &points, false };
+
+		// the target moving with the point cancels out the point's own velocity
+		SpringEnd b{ nullptr, points.globalX.data(), points.globalY.data(), points.globalZ.data() };
+		if (!stillTarget) {
+			b.velX = a.velX;
+			b.velY = a.velY;
+			b.velZ = a.velZ;
+		}
+
+		accumulateSprings(0, points.size(), nullptr, a, b, k, damping);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Engine.h"
+#include "Component/JointList.h"
+#include "Component/PointMasses.h"
+#include "Utils/Lanes.h"
+
+#include <cstdint>
+
+/**
+ * @brief Damped spring kernels for the force integrator.
+ *
+ * Springs are evaluated a vector's worth at a time, gathering their end points through index arrays, and the forces are
+ * then added back one lane at a time. Joints and shape matching both go through the same kernel; shape matching is just
+ * a run of springs from each point to its own spot on the global shape.
+ */
+namespace Squishies::JointKernels
+{
+	constexpr size_t WIDTH = Lanes::WIDTH;
+
+	/**
+	 * @brief One end of a run of springs
+	 */
+	struct SpringEnd
+	{
+		const uint32_t* index{ nullptr };							// point per spring, or null if spring i ends at point i
+		const float* posX{ nullptr };
+		const float* posY{ nullptr };
+		const float* posZ{ nullptr };
+		const float* velX{ nullptr };								// null if this end isn't moving
+		const float* velY{ nullptr };
+		const float* velZ{ nullptr };
+		Component::PointMasses* points{ nullptr };					// takes the force, or null if this end takes none
+		bool skipFixed{ false };									// leave fixed points out of the force
+	};
+
+	/**
+	 * @brief Add the forces of springs [first, first + count), pulling a towards b and b towards a.
+	 *
+	 * No point may take force from two springs in the run. rest is per spring, or null for zero length. Ends closer than
+	 * .01 exert nothing, as with wf::getSpringForce().
+	 */
+	void accumulateSprings(size_t first, size_t count, const float* rest, const SpringEnd& a, const SpringEnd& b, float k, float damping);
+
+	/**
+	 * @brief Add the forces of every joint, batch by batch
+	 */
+	void accumulateJoints(const Component::JointList& joints, Component::PointMasses& points, float k, float damping);
+
+	/**
+	 * @brief Add the forces pulling each point towards its place on the global shape. With a still target the damping
+	 * works against the points' own velocity, otherwise the target moves with them and there is none
+	 */
+	void accumulateShapeMatch(Component::PointMasses& points, float k, float damping, bool stillTarget);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+namespace Squishies
+{
+	/**
+	 * @brief The handful of lane operations the SIMD kernels need, one set per instruction set: 8 lanes with AVX2, 4 with
+	 * SSE2, or a scalar fallback.
+	 *
+	 * Comparisons are all ordered (false on NaN) to match plain C++ float comparisons, so the scalar set gives exactly the
+	 * same answers.
+	 */
+#if defined(__AVX2__)
+	struct Lanes
+	{
+		using V = __m256;
+		static constexpr size_t WIDTH = 8;
+
+		static V load(const float* p) { return _mm256_loadu_ps(p); }
+		static V gather(const float* base, const uint32_t* idx) { return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)), 4); }
+		static V set(float v) { return _mm256_set1_ps(v); }
+		static V add(V a, V b) { return _mm256_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm256_div_ps(a, b); }
+		static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+		static V lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static V le(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static V gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static V ge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static V maskAnd(V a, V b) { return _mm256_and_ps(a, b); }
+		static V maskXor(V a, V b) { return _mm256_xor_ps(a, b); }
+		static V select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+		static uint32_t bits(V mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+		static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+	};
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	struct Lanes
+	{
+		using V = __m128;
+		static constexpr size_t WIDTH = 4;
+
+		static V load(const float* p) { return _mm_loadu_ps(p); }
+		static V gather(const float* base, const uint32_t* idx) { return _mm_setr_ps(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]); }
+		static V set(float v) { return _mm_set1_ps(v); }
+		static V add(V a, V b) { return _mm_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm_div_ps(a, b); }
+		static V sqrt(V a) { return _mm_sqrt_ps(a); }
+		static V lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+		static V le(V a, V b) { return _mm_cmple_ps(a, b); }
+		static V gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+		static V ge(V a, V b) { return _mm_cmpge_ps(a, b); }
+		static V maskAnd(V a, V b) { return _mm_and_ps(a, b); }
+		static V maskXor(V a, V b) { return _mm_xor_ps(a, b); }
+		static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		static uint32_t bits(V mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask)); }
+		static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+	};
+#else
+	struct Lanes
+	{
+		// masks are all-ones / all-zeros floats, same as the vector sets
+		using V = float;
+		static constexpr size_t WIDTH = 1;
+
+		static V maskOf(bool b) { return std::bit_cast<float>(b ? 0xFFFFFFFFu : 0u); }
+		static bool isSet(V m) { return std::bit_cast<uint32_t>(m) != 0; }
+
+		static V load(const float* p) { return *p; }
+		static V gather(const float* base, const uint32_t* idx) { return base[*idx]; }
+		static V set(float v) { return v; }
+		static V add(V a, V b) { return a + b; }
+		static V sub(V a, V b) { return a - b; }
+		static V mul(V a, V b) { return a * b; }
+		static V div(V a, V b) { return a / b; }
+		static V sqrt(V a) { return std::sqrt(a); }
+		static V lt(V a, V b) { return maskOf(a < b); }
+		static V le(V a, V b) { return maskOf(a <= b); }
+		static V gt(V a, V b) { return maskOf(a > b); }
+		static V ge(V a, V b) { return maskOf(a >= b); }
+		static V maskAnd(V a, V b) { return maskOf(isSet(a) && isSet(b)); }
+		static V maskXor(V a, V b) { return maskOf(isSet(a) != isSet(b)); }
+		static V select(V mask, V a, V b) { return isSet(mask) ? a : b; }
+		static uint32_t bits(V mask) { return isSet(mask) ? 1u : 0u; }
+		static void store(float* p, V v) { *p = v; }
+	};
+#endif
+
+	/**
+	 * @brief Rounds a count up to whole lanes, so vector loops never need a scalar tail
+	 */
+	constexpr size_t padToLanes(size_t count) { return ((count + Lanes::WIDTH - 1) / Lanes::WIDTH) * Lanes::WIDTH; }
+
+	/**
+	 * @brief Whole lanes plus one spare vector, so a full-width load starting at any real entry stays in bounds
+	 */
+	constexpr size_t padForLoads(size_t count) { return padToLanes(count) + Lanes::WIDTH; }
+}
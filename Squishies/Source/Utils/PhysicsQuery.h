@@ -0,0 +1,72 @@
+#pragma once
+#include "Engine.h"
+
+#include "Component/ColliderComponent.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Squishies
+{
+	/**
+	 * @brief Which bodies a query is interested in, by the same rule as collisions: the body's group has to be in the
+	 * query's mask, and the query's group in the body's. Bodies without a Collider are DEFAULT, colliding with ALL
+	 */
+	struct QueryFilter
+	{
+		int collisionGroup = CollisionGroup::ALL;
+		int collisionMask = CollisionGroup::ALL;
+
+		bool accepts(int group, int mask) const
+		{
+			return (collisionMask & group) && (mask & collisionGroup);
+		}
+	};
+
+	/**
+	 * @brief Where a ray or nearest query found a body
+	 */
+	struct QueryHit
+	{
+		wf::EntityID entity{ entt::null };
+		wf::Vec3 point{};											// where the ray crossed the outline, or the closest point on it
+		wf::Vec2 normal{};											// the edge's outward normal
+		float distance{ 0.f };										// along the ray, or from the query point; 0 if it's inside
+		size_t edge{ SIZE_MAX };									// edge i runs from point i to point i + 1
+	};
+
+	/**
+	 * @brief Spatial queries against the soft bodies, for gameplay (explosions, picking, AI) rather than the simulation.
+	 *
+	 * The bodies are 2D, so everything is in the XY plane and z is ignored. Queries go through the broadphase grid, so
+	 * they only look at bodies near what's asked about, and read the bodies as they are now; with a simulation thread,
+	 * only make them between syncing and launching it (i.e. from update and event handlers).
+	 */
+	class IPhysicsQuery
+	{
+	public:
+		virtual ~IPhysicsQuery() = default;
+
+		/**
+		 * @brief Gather the bodies whose bounding box overlaps the region
+		 */
+		virtual void queryRegion(const wf::BoundingBox& region, std::vector<wf::EntityID>& out, const QueryFilter& filter = {}) = 0;
+
+		/**
+		 * @brief Gather the bodies with any part of their outline within the radius, or that the centre is inside
+		 */
+		virtual void queryRadius(const wf::Vec3& centre, float radius, std::vector<wf::EntityID>& out, const QueryFilter& filter = {}) = 0;
+
+		/**
+		 * @brief The first edge within maxDistance that the ray enters a body through. A ray starting inside a body passes
+		 * out of it unseen
+		 */
+		virtual bool raycast(const wf::Ray& ray, float maxDistance, QueryHit& hit, const QueryFilter& filter = {}) = 0;
+
+		/**
+		 * @brief The body nearest the point, if any is within maxDistance. Use a maxDistance of 0 to pick the body the
+		 * point is inside
+		 */
+		virtual bool nearest(const wf::Vec3& point, float maxDistance, QueryHit& hit, const QueryFilter& filter = {}) = 0;
+	};
+}
@@ -8,11 +8,9 @@ out vec4 finalColour;
 
 void main()
 {
-    if (diffuseColour != vec4(0.0)) {
-        finalColour = diffuseColour;
-    } else if (fragColour != vec4(0.0)) {
-        finalColour = fragColour;
-    } else {
-        finalColour = vec4(1.0);
-    }
+    // either colour tints the other, like the phong shader; an unset one counts as white
+    vec4 base = diffuseColour != vec4(0.0) ? diffuseColour : vec4(1.0);
+    vec4 tint = fragColour != vec4(0.0) ? fragColour : vec4(1.0);
+
+    finalColour = base * tint;
 }